@@ -8,13 +8,48 @@
 #pragma once
 #include "../source/Allocation.hpp"
 #include "../source/Pool.hpp"
+#include "../source/PoolDirectory.hpp"
+#include "../source/Chain.hpp"
+#include "../source/LargeBlock.hpp"
+#include "../source/Region.hpp"
 #include <unordered_set>
+#include <set>
 #include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <span>
+#include <vector>
+#include <chrono>
 
 
 namespace Langulus::Fractalloc
 {
 
+   ///                                                                        
+   ///   Pool commit policy                                                   
+   ///                                                                        
+   /// Decides how the memory of a new pool is committed by the OS. Without   
+   /// committing, the memory might remain just a promise by the OS, making   
+   /// initial pool allocations very, very, VERY slow, but committing costs   
+   /// time on the thread that makes the pool                                 
+   ///                                                                        
+   enum class CommitPolicy {
+      // Touch every page of the pool, one by one (Pool::Touch)         
+      Touch,
+      // Ask the OS to commit all pages in a single system call, falls  
+      // back to Touch if not supported                                 
+      Populate,
+      // Don't commit anything - pages are committed on first use       
+      Lazy,
+      // Commit all pages, and pin them in physical memory, for pools   
+      // that must never page-fault; falls back to Touch if the process 
+      // exceeds its locked memory limit                                
+      Lock
+   };
+
+
    ///                                                                        
    ///   Memory allocator                                                     
    ///                                                                        
@@ -22,6 +57,25 @@ namespace Langulus::Fractalloc
    /// Basically an overcomplicated wrapper for malloc/free                   
    ///                                                                        
    struct Allocator {
+      friend class Pool;
+      friend class Region;
+      friend struct ThreadCache;
+
+      ///                                                                     
+      /// Progress of an incremental garbage collection, see CollectGarbage   
+      ///                                                                     
+      struct GarbageProgress {
+         // Number of pools visited, and released by the call           
+         Count mVisited {};
+         Count mReleased {};
+         // Chains visited so far in the current pass, out of all       
+         Count mChain {};
+         Count mChains {};
+         // True if the call completed the current pass, and the next   
+         // call will start over                                        
+         bool mDone {};
+      };
+
       #if LANGULUS_FEATURE(MEMORY_STATISTICS)
          ///                                                                  
          /// Structure for keeping track of allocations                       
@@ -38,6 +92,23 @@ namespace Langulus::Fractalloc
             // Increases with each call to State::Assert, used to       
             // diff pools                                               
             Count mStep {};
+            // Pool lookups by address, that were resolved by the       
+            // per-thread recent pool cache, or missed it               
+            Count mFindHits {};
+            Count mFindMisses {};
+            // Number of registered pools, that the OS accepted to back 
+            // with huge pages, see LANGULUS_FRACTALLOC(HUGE_PAGES)     
+            Count mHugePagePools {};
+            // Time spent committing new pools, see CommitPolicy        
+            ::std::chrono::nanoseconds mCommitTime {};
+            // Number of pools linked into chains, that were prepared   
+            // by the provisioner, or that had to be made on the spot   
+            // by the allocating thread, see StartProvisioner           
+            Count mProvisionedPools {};
+            Count mSynchronousPools {};
+            // Number of pools linked into chains, that were taken from 
+            // the reserve of empty pools, see SetReserve               
+            Count mReusedPools {};
 
             #if LANGULUS_FEATURE(MANAGED_REFLECTION)
                // Number of registered meta datas                       
@@ -50,7 +121,7 @@ namespace Langulus::Fractalloc
 
             bool operator == (const Statistics&) const noexcept;
 
-            void AddPool(const Pool*) noexcept;
+            void AddPool(Pool*) noexcept;
             void DelPool(const Pool*) noexcept;
          };
       
@@ -63,6 +134,8 @@ namespace Langulus::Fractalloc
             // The previous state                                       
             ::std::optional<Statistics> mState;
 
+            static void NextStep() noexcept;
+
          public:
             LANGULUS_API(FRACTALLOC) bool Assert();
          };
@@ -78,40 +151,174 @@ namespace Langulus::Fractalloc
       #endif
 
    private:
-      // Default pool chain                                             
-      Pool* mMainPoolChain {};
-      // The last succesfull Find() result in default pool chain        
-      mutable const Pool* mLastFoundPool {};
+      // Guards the pool chains, and all pools that aren't claimed by a 
+      // thread cache                                                   
+      mutable ::std::mutex mMutex;
 
-      // Pool chains for types that use PoolTactic::Size                
+      // Default pool chain - it serves untyped requests of any size,   
+      // whose density tells nothing about future demand, so its pools  
+      // never grow                                                     
+      Chain mMainPoolChain {.mPoolSizeMax = Pool::DefaultPoolSize};
+      // Maps addresses to the pools that contain them, for all chains  
+      // Kept up to date by AllocatePool and DeallocatePool             
+      PoolDirectory mDirectory;
+      // How new pools are committed                                    
+      ::std::atomic<CommitPolicy> mCommitPolicy {CommitPolicy::Touch};
+      // Incremented with each deallocated pool, so that thread caches  
+      // know when to forget the pools they recently found              
+      ::std::atomic<Count> mPoolEpoch {};
+      // All live thread caches, doubly-linked through                  
+      // ThreadCache::mNextCache and ThreadCache::mPrevCache, so that   
+      // pools are reused only after the searches that might see them   
+      ThreadCache* mCaches {};
+      ::std::mutex mCachesMutex;
+
+      // Pool chains for types that use PoolTactic::Size, one for each  
+      // power-of-two the element size rounds up to, see SizeBucket     
       static constexpr Count SizeBuckets = sizeof(Offset) * 8;
-      Pool* mSizePoolChain[SizeBuckets] {};
+      Chain mSizePoolChain[SizeBuckets];
+      // Pool chains for requests aligned beyond Alignment, one for     
+      // each power-of-two alignment, regardless of type                
+      static constexpr Count AlignmentBuckets = sizeof(Offset) * 8;
+      Chain mAlignedPoolChain[AlignmentBuckets];
+
+      // Blocks for requests that don't fit in pools, ordered by        
+      // address, so that they can be found by any address inside       
+      ::std::set<const LargeBlock*> mLargeBlocks;
+      // Guards mLargeBlocks on its own, so that searches don't take    
+      // mMutex, and blocks aren't unmapped while being searched        
+      mutable ::std::shared_mutex mLargeMutex;
 
+      // Types that use PoolTactic::Type keep their own Chain, made on  
+      // demand, and referenced by RTTI::MetaData::GetPool<Chain>()     
       // A set of types, that are currently in use                      
       // Used to detect if a shared object is safe to be unloaded       
       // MUST BE BY POINTER, because there can be multiple definitions  
       ::std::unordered_set<const RTTI::MetaData*> mInstantiatedTypes;
 
+      // Background thread, that prepares spare pools before chains run 
+      // out of space, so that allocating threads just link them in     
+      ::std::thread mProvisioner;
+      ::std::condition_variable mProvisionerSignal;
+      // Spare default-sized pools, that aren't in any chain yet,       
+      // linked through Pool::mNext                                     
+      Pool* mSpares {};
+      Count mSpareCount {};
+      // Number of spares the provisioner maintains, zero if stopped    
+      Count mSpareTarget {};
+      // Set when a chain nears exhaustion, and spares must be topped up
+      bool mSparesWanted {};
+
+      // Background threads, that help CollectGarbage trim pools. They  
+      // are started on demand, and kept for later collections          
+      ::std::vector<::std::thread> mTrimmers;
+      ::std::mutex mTrimMutex;
+      ::std::condition_variable mTrimSignal;
+      ::std::condition_variable mTrimDone;
+      // The batch being trimmed, and the next pool in it to trim       
+      ::std::span<Pool* const> mTrimBatch;
+      ::std::atomic<Count> mTrimNext {};
+      // Number of trimmers that can still join the batch, and number   
+      // of trimmers working on it                                      
+      Count mTrimHelpers {};
+      Count mTrimBusy {};
+      bool mTrimStop {};
+
+      // Empty pools, kept mapped and committed by CollectGarbage, so   
+      // that the next burst of allocations doesn't have to make them   
+      // again. Sorted by size, and linked through Pool::mNext          
+      Pool* mReserve {};
+      Count mReserveCount {};
+      Offset mReserveBytes {};
+      // Limits of the reserve, see SetReserve                          
+      static constexpr Count DefaultReservePools = 4;
+      static constexpr Offset DefaultReserveBytes = 4 * Pool::DefaultPoolSize;
+      Count mReserveMaxCount = DefaultReservePools;
+      Offset mReserveMaxBytes = DefaultReserveBytes;
+      // Pools taken from the reserve since the last collection pass    
+      // The reserve decays, while there are none                       
+      Count mReserveHits {};
+
+      // Unclaimed pools, that became empty since they were last        
+      // collected, doubly-linked through Pool::mEmptyNext and          
+      // Pool::mEmptyPrev. Some of them might be in use again           
+      Pool* mEmptyPools {};
+
+      // State of the incremental garbage collection - the pass is      
+      // stamped on each visited pool, and the pass resumes from the    
+      // chain it stopped at: main chain, size chains, then type chains 
+      Count mCollectPass {};
+      Count mCollectChain {};
+      bool mCollecting {};
+      // The type chains at the start of the pass                       
+      ::std::vector<const RTTI::MetaData*> mCollectTypes;
+      // Pools gathered per worker, before trimming them                
+      static constexpr Count CollectBatch = 16;
+
    private:
       #if LANGULUS_FEATURE(MEMORY_STATISTICS)
          LANGULUS_API(FRACTALLOC)
          static void DumpPool(Offset, const Pool*) noexcept;
          
          NOD() LANGULUS_API(FRACTALLOC)
-         bool IntegrityCheckChain(const Pool*);
+         bool IntegrityCheckChain(const Chain&);
+
+         LANGULUS_API(FRACTALLOC)
+         static void AddEntries(Count, Offset) noexcept;
+         LANGULUS_API(FRACTALLOC)
+         static void DelEntries(Count, Offset) noexcept;
       #endif
 
-      LANGULUS_API(FRACTALLOC)
-      void CollectGarbageChain(Pool*&);
+      NOD() LANGULUS_API(FRACTALLOC)
+      static Pool* AllocateBumpPool(DMeta, Offset) IF_UNSAFE(noexcept);
 
-      const Allocation* FindInChain(const void*, const Pool*) const IF_UNSAFE(noexcept);
-      bool ContainedInChain(const void*, const Pool*) const IF_UNSAFE(noexcept);
+      bool CollectGarbageChain(Chain&, const void*, ::std::vector<Pool*>&, Count, GarbageProgress&, Pool*&);
+      void BeginCollection();
+      void ListEmpty(Pool*) noexcept;
+      void UnlistEmpty(Pool*) noexcept;
+      void DiscardPool(Pool*, Pool*&) IF_UNSAFE(noexcept);
+      void ReserveDiscarded(::std::unique_lock<::std::mutex>&, Pool*&) IF_UNSAFE(noexcept);
+      bool CollectStep(::std::vector<Pool*>&, Count, GarbageProgress&, Pool*&);
+      void TrimBatch(::std::span<Pool* const>, Count);
+      void HelpTrim();
+      void StopTrimmers();
+      void ReleaseBatch(::std::span<Pool* const>) IF_UNSAFE(noexcept);
+
+      static Offset SizeBucket(DMeta, Offset) noexcept;
+      static const void* ChainKey(DMeta, Offset, Offset) noexcept;
+      Chain* ChainOf(DMeta, Offset, Offset) noexcept;
+      Allocation* AllocateSlow(DMeta, const void*, Offset, Offset) IF_UNSAFE(noexcept);
+      Pool* TakeSpare(Offset) noexcept;
+      Pool* TakeReserved(Offset) IF_UNSAFE(noexcept);
+      void ReservePool(Pool*) IF_UNSAFE(noexcept);
+      void TrimReserve(Count, Offset) IF_UNSAFE(noexcept);
+      void Provision();
+      void ReleasePool(Pool*) IF_UNSAFE(noexcept);
+      static void SortPool(Pool*) noexcept;
+      static Pool* MapPool(DMeta, Offset) IF_UNSAFE(noexcept);
+      static bool PublishPool(Pool*) IF_UNSAFE(noexcept);
+      void RegisterCache(ThreadCache&);
+      void ReleaseCache(ThreadCache&) IF_UNSAFE(noexcept);
+      void WaitForSearches() noexcept;
+      void FlushStatistics(ThreadCache&) noexcept;
+      const Pool* FindPool(const void*) IF_UNSAFE(noexcept);
+      const LargeBlock* FindLarge(const void*) const noexcept;
+      Allocation* AllocateLarge(DMeta, Offset, Offset) IF_UNSAFE(noexcept);
+      void DeallocateLarge(Allocation*) IF_UNSAFE(noexcept);
 
       static void DumpAllocation(RTTI::DMeta hint, const Pool*, const Allocation*) noexcept;
 
    public:
+      LANGULUS_API(FRACTALLOC) ~Allocator();
+
       NOD() LANGULUS_API(FRACTALLOC)
-      static Allocation* Allocate(RTTI::DMeta, Offset) IF_UNSAFE(noexcept);
+      static Allocation* Allocate(RTTI::DMeta, Offset, Offset = Alignment) IF_UNSAFE(noexcept);
+
+      NOD() LANGULUS_API(FRACTALLOC)
+      static Count AllocateBatch(RTTI::DMeta, Offset, ::std::span<Allocation*>, Offset = Alignment) IF_UNSAFE(noexcept);
+
+      NOD() LANGULUS_API(FRACTALLOC)
+      static Count AllocateBatch(RTTI::DMeta, Offset, Count, Allocation**, Offset = Alignment) IF_UNSAFE(noexcept);
 
       NOD() LANGULUS_API(FRACTALLOC)
       static Allocation* Reallocate(Offset, Allocation*) IF_UNSAFE(noexcept);
@@ -119,9 +326,15 @@ namespace Langulus::Fractalloc
       LANGULUS_API(FRACTALLOC)
       static void Deallocate(Allocation*) IF_UNSAFE(noexcept);
 
+      LANGULUS_API(FRACTALLOC)
+      static void DeallocateBatch(::std::span<Allocation*>) IF_UNSAFE(noexcept);
+
       NOD() LANGULUS_API(FRACTALLOC)
       static const Allocation* Find(RTTI::DMeta, const void*) IF_UNSAFE(noexcept);
 
+      LANGULUS_API(FRACTALLOC)
+      static void FindBatch(RTTI::DMeta, ::std::span<const void* const>, ::std::span<const Allocation*>) IF_UNSAFE(noexcept);
+
       NOD() LANGULUS_API(FRACTALLOC)
       static bool CheckAuthority(RTTI::DMeta, const void*) IF_UNSAFE(noexcept);
 
@@ -134,6 +347,27 @@ namespace Langulus::Fractalloc
       LANGULUS_API(FRACTALLOC)
       static bool CollectGarbage();
 
+      LANGULUS_API(FRACTALLOC)
+      static GarbageProgress CollectGarbage(::std::chrono::nanoseconds, Count = 1);
+
+      LANGULUS_API(FRACTALLOC)
+      static Count CollectEmptyPools();
+
+      LANGULUS_API(FRACTALLOC)
+      static void SetCommitPolicy(CommitPolicy) noexcept;
+
+      NOD() LANGULUS_API(FRACTALLOC)
+      static CommitPolicy GetCommitPolicy() noexcept;
+
+      LANGULUS_API(FRACTALLOC)
+      static bool StartProvisioner(Count = 2);
+
+      LANGULUS_API(FRACTALLOC)
+      static void StopProvisioner();
+
+      LANGULUS_API(FRACTALLOC)
+      static void SetReserve(Count, Offset) IF_UNSAFE(noexcept);
+
       #if LANGULUS_FEATURE(MANAGED_REFLECTION)
          LANGULUS_API(FRACTALLOC)
          static Count CheckBoundary(const Token&) noexcept;
@@ -141,7 +375,7 @@ namespace Langulus::Fractalloc
 
       #if LANGULUS_FEATURE(MEMORY_STATISTICS)
          NOD() LANGULUS_API(FRACTALLOC)
-         static auto GetStatistics() noexcept -> const Statistics&;
+         static auto GetStatistics() noexcept -> Statistics;
 
          LANGULUS_API(FRACTALLOC)
          static void DumpPools() noexcept;
@@ -164,3 +398,4 @@ namespace Langulus::Fractalloc
 
 #include "../source/Allocation.inl"
 #include "../source/Pool.inl"
+#include "../source/Region.inl"
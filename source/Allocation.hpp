@@ -8,6 +8,8 @@
 #pragma once
 #include "Config.hpp"
 #include <RTTI/Meta.hpp>
+#include <cstdint>
+#include <limits>
 
 
 namespace Langulus::Fractalloc
@@ -30,6 +32,19 @@ namespace Langulus::Fractalloc
    friend class Pool;
    friend struct Allocator;
    protected:
+   #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+      // Allocated bytes for this chunk                                 
+      ::std::uint32_t mAllocatedBytes;
+      // The number of references to this memory                        
+      ::std::uint32_t mReferences;
+      // Distance from the pool that owns the allocation to the entry,  
+      // in multiples of Alignment, or zero if not in a pool. Shifted   
+      // left by one, because the lowest bit tells if the header is     
+      // detached from the block, see Detach                            
+      // When the entry isn't used, the link to the next free entry is  
+      // kept at the start of its block instead, see GetNextFree        
+      ::std::uint32_t mPoolOffset;
+   #else
       // Allocated bytes for this chunk                                 
       Offset mAllocatedBytes;
       // The number of references to this memory                        
@@ -41,13 +56,24 @@ namespace Langulus::Fractalloc
          //    feature is not enabled                                   
          // If mReferences == 0, it refers to the next free entry to be 
          //    reused                                                   
+         // Unless headers are detached, the lowest bit of mPool tells  
+         // if this header is detached from the block, in which case    
+         // the pool is always kept, and the next free entry is linked  
+         // from the start of the block instead, see Detach             
          Pool* mPool;
          Allocation* mNextFreeEntry;
       };
 
-   #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-      // Acts like a timestamp of when the allocation happened          
-      Count mStep;
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         // Start of the client memory. Pools keep the entry in their   
+         // array of headers, away from the memory, see Pool::mHeaders  
+         Byte* mBlock;
+      #endif
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         // Acts like a timestamp of when the allocation happened       
+         Count mStep;
+      #endif
    #endif
 
    public:
@@ -56,9 +82,15 @@ namespace Langulus::Fractalloc
       Allocation(Allocation&&) = delete;
       ~Allocation() = delete;
 
-      constexpr Allocation(Offset, Pool*) noexcept;
+      Allocation(Offset, Pool*) IF_UNSAFE(noexcept);
+
+      // The biggest number of bytes an allocation can have             
+      static constexpr Offset MaxBytes = LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         ? Offset {::std::numeric_limits<::std::uint32_t>::max()}
+         : ::std::numeric_limits<Offset>::max();
 
       NOD() static constexpr Offset GetSize() noexcept;
+      NOD() static constexpr Offset GetOverhead() noexcept;
       NOD() static constexpr Offset GetNewAllocationSize(Offset) noexcept;
       NOD() static constexpr Offset GetMinAllocation() noexcept;
 
@@ -70,6 +102,16 @@ namespace Langulus::Fractalloc
       NOD() bool Contains(const void*) const noexcept;
       NOD() bool CollisionFree(const Allocation&) const noexcept;
 
+      NOD() Pool* GetPool() const noexcept;
+      void SetPool(Pool*) IF_UNSAFE(noexcept);
+      NOD() Allocation* GetNextFree() const noexcept;
+      void SetNextFree(Allocation*) noexcept;
+
+   #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+      NOD() bool IsDetached() const noexcept;
+      void Detach() noexcept;
+   #endif
+
       template<class T>
       NOD() T* As() const noexcept;
 
@@ -7,7 +7,9 @@
 ///                                                                           
 #pragma once
 #include "Allocation.hpp"
+#include "Pool.hpp"
 #include <Core/Utilities.hpp>
+#include <cstring>
 
 
 namespace Langulus::Fractalloc
@@ -61,10 +63,22 @@ namespace Langulus::Fractalloc
    ///   @param bytes - the number of allocated bytes                         
    ///   @param pool - the pool/handle of the entry                           
    LANGULUS(INLINED)
-   constexpr Allocation::Allocation(Offset bytes, Pool* pool) noexcept
-      : mAllocatedBytes {bytes}
-      , mReferences {1}
-      , mPool {pool} {}
+   Allocation::Allocation(Offset bytes, Pool* pool) IF_UNSAFE(noexcept)
+      : mAllocatedBytes {static_cast<decltype(mAllocatedBytes)>(bytes)}
+      , mReferences {1} {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         mPoolOffset = 0;
+      #elif not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         mPool = nullptr;
+      #endif
+      SetPool(pool);
+
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         // Entries in large blocks are followed by their memory, while 
+         // pools move it elsewhere, see Pool::Allocate                 
+         mBlock = reinterpret_cast<Byte*>(this) + GetSize();
+      #endif
+   }
 
    /// Get the size of the Allocation structure, rounded up for alignment     
    ///   @return the byte size of the entry, including alignment              
@@ -75,14 +89,22 @@ namespace Langulus::Fractalloc
       return sizeof(Allocation) + Alignment - (sizeof(Allocation) % Alignment);
    }
 
+   /// Get the number of bytes a pooled entry takes in front of its client    
+   /// memory - the header, unless LANGULUS_FRACTALLOC(DETACHED_HEADERS)      
+   ///   @return the byte size of the overhead, including alignment           
+   LANGULUS(INLINED)
+   constexpr Offset Allocation::GetOverhead() noexcept {
+      return LANGULUS_FRACTALLOC(DETACHED_HEADERS) ? 0 : Allocation::GetSize();
+   }
+
    /// Get the size required for allocating a new Allocation                  
-   /// The layout is: [Allocation::GetSize()][client memory]                  
+   /// The layout is: [Allocation::GetOverhead()][client memory]              
    ///   @param size - the usable number of bytes required                    
    ///   @return the byte size for a new Allocation, including padding        
    LANGULUS(INLINED)
    constexpr Offset Allocation::GetNewAllocationSize(Offset size) noexcept {
       const auto minimum  = Allocation::GetMinAllocation();
-      const auto proposed = Allocation::GetSize() + size;
+      const auto proposed = Allocation::GetOverhead() + size;
       return ::std::max(proposed, minimum);
    }
 
@@ -90,7 +112,7 @@ namespace Langulus::Fractalloc
    ///   @return the byte size                                                
    LANGULUS(INLINED)
    constexpr Offset Allocation::GetMinAllocation() noexcept {
-      return Allocation::GetSize() + Alignment;
+      return Allocation::GetOverhead() + Alignment;
    }
 
    /// Check if the memory of the entry is in use                             
@@ -101,11 +123,21 @@ namespace Langulus::Fractalloc
    }
 
    /// Return the aligned start of usable block memory (const)                
+   /// Detached headers find their block through their pool, see Detach       
    ///   @return pointer to the entry's memory                                
    LANGULUS(INLINED)
    Byte* Allocation::GetBlockStart() const noexcept {
-      const auto entryStart = reinterpret_cast<const Byte*>(this);
-      return const_cast<Byte*>(entryStart + Allocation::GetSize());
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         return mBlock;
+      #else
+         if (IsDetached()) {
+            const auto pool = GetPool();
+            return pool->BlockFromIndex(pool->IndexFromEntry(this));
+         }
+
+         const auto entryStart = reinterpret_cast<const Byte*>(this);
+         return const_cast<Byte*>(entryStart + Allocation::GetSize());
+      #endif
    }
 
    /// Return the end of usable block memory (always const)                   
@@ -116,10 +148,10 @@ namespace Langulus::Fractalloc
    }
    
    /// Get the total of the entry, and its allocated data, in bytes           
-   ///   @return the byte size of the entry plus the usable region after it   
+   ///   @return the byte size of the entry overhead plus the usable region   
    LANGULUS(INLINED)
    constexpr Offset Allocation::GetTotalSize() const noexcept {
-      return Allocation::GetSize() + mAllocatedBytes;
+      return Allocation::GetOverhead() + mAllocatedBytes;
    }
 
    /// Get the number of allocated bytes in this entry                        
@@ -150,6 +182,115 @@ namespace Langulus::Fractalloc
          and (blockStart1 - blockStart2) > ::std::ptrdiff_t(other.mAllocatedBytes);
    }
 
+   /// Get the pool that owns the entry                                       
+   ///   @attention assumes entry is in use                                   
+   ///   @return the pool, or nullptr if entry is in a large block            
+   LANGULUS(INLINED)
+   Pool* Allocation::GetPool() const noexcept {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         const auto distance = Offset {mPoolOffset >> 1} * Alignment;
+         if (not distance)
+            return nullptr;
+         return reinterpret_cast<Pool*>(const_cast<Byte*>(
+            reinterpret_cast<const Byte*>(this) - distance));
+      #elif LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         return mPool;
+      #else
+         return reinterpret_cast<Pool*>(reinterpret_cast<Pointer>(mPool) & ~Pointer {1});
+      #endif
+   }
+
+   /// Set the pool that owns the entry                                       
+   /// Whether the header is detached remains as it was                       
+   ///   @attention with LANGULUS_FRACTALLOC(COMPACT_HEADERS) the entry must  
+   ///      be in reach of the pool, see Pool::MaxPoolSize                    
+   ///   @param pool - the pool, or nullptr if entry is in a large block      
+   LANGULUS(INLINED)
+   void Allocation::SetPool(Pool* pool) IF_UNSAFE(noexcept) {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         const Offset distance = pool ? Offset(
+            reinterpret_cast<const Byte*>(this) - reinterpret_cast<const Byte*>(pool)
+         ) / Alignment : 0;
+         LANGULUS_ASSUME(DevAssumes,
+            distance <= (::std::numeric_limits<::std::uint32_t>::max() >> 1),
+            "Entry is too far from its pool");
+         mPoolOffset = static_cast<::std::uint32_t>(distance << 1) | (mPoolOffset & 1);
+      #elif LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         mPool = pool;
+      #else
+         mPool = reinterpret_cast<Pool*>(reinterpret_cast<Pointer>(pool)
+            | (reinterpret_cast<Pointer>(mPool) & Pointer {1}));
+      #endif
+   }
+
+   /// Get the next entry in a list of freed entries                          
+   ///   @attention assumes entry is freed, and is in such a list             
+   ///   @return the next entry, or nullptr if this is the last one           
+   LANGULUS(INLINED)
+   Allocation* Allocation::GetNextFree() const noexcept {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         Allocation* next;
+         ::std::memcpy(&next, GetBlockStart(), sizeof(next));
+         return next;
+      #else
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            if (IsDetached()) {
+               Allocation* next;
+               ::std::memcpy(&next, GetBlockStart(), sizeof(next));
+               return next;
+            }
+         #endif
+         return mNextFreeEntry;
+      #endif
+   }
+
+   /// Link the entry to the next one in a list of freed entries              
+   /// With LANGULUS_FRACTALLOC(COMPACT_HEADERS), or if the header is         
+   /// detached, the link is kept at the start of the block, which is no      
+   /// longer used by the client, and is always big enough for a pointer,     
+   /// see GetMinAllocation                                                   
+   ///   @param next - the next entry, or nullptr if this is the last one     
+   LANGULUS(INLINED)
+   void Allocation::SetNextFree(Allocation* next) noexcept {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         ::std::memcpy(GetBlockStart(), &next, sizeof(next));
+      #else
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            if (IsDetached()) {
+               ::std::memcpy(GetBlockStart(), &next, sizeof(next));
+               return;
+            }
+         #endif
+         mNextFreeEntry = next;
+      #endif
+   }
+
+   #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+   /// Check if the header is kept away from the block, in the header array   
+   /// of a slab, see Pool::MakeSlab                                          
+   ///   @return true if the header is detached                               
+   LANGULUS(INLINED)
+   bool Allocation::IsDetached() const noexcept {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         return mPoolOffset & 1;
+      #else
+         return reinterpret_cast<Pointer>(mPool) & Pointer {1};
+      #endif
+   }
+
+   /// Mark the header as kept away from the block - the block is then found  
+   /// through the pool, and the header always keeps it, see GetBlockStart    
+   ///   @attention assumes entry is in a pool                                
+   LANGULUS(INLINED)
+   void Allocation::Detach() noexcept {
+      #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+         mPoolOffset |= 1;
+      #else
+         mPool = reinterpret_cast<Pool*>(reinterpret_cast<Pointer>(mPool) | Pointer {1});
+      #endif
+   }
+   #endif
+
    /// Get the start of the entry as a given type                             
    ///   @return a pointer to the first element                               
    template<class T> LANGULUS(INLINED)
@@ -168,7 +309,7 @@ namespace Langulus::Fractalloc
    ///   @param c - the number of references to add                           
    LANGULUS(INLINED)
    constexpr void Allocation::Keep(Count c) noexcept {
-      mReferences += c;
+      mReferences += static_cast<decltype(mReferences)>(c);
    }
 
    /// Dereference the entry once                                             
@@ -181,7 +322,7 @@ namespace Langulus::Fractalloc
    ///   @param c - the number of references to remove                        
    LANGULUS(INLINED)
    constexpr void Allocation::Free(Count c) noexcept {
-      mReferences -= c;
+      mReferences -= static_cast<decltype(mReferences)>(c);
    }
 
 } // namespace Langulus::Fractalloc
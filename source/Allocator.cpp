@@ -9,6 +9,8 @@
 #include <RTTI/Assume.hpp>
 #include "Pool.inl"
 #include "Allocation.inl"
+#include "ThreadCache.hpp"
+#include <algorithm>
 
 #if 0
    #define VERBOSE_ENABLED() 1
@@ -26,41 +28,125 @@ namespace Langulus::Fractalloc
    
    using RTTI::MetaData;
 
-   /// MSVC will likely never support std::aligned_alloc, so we use           
-   /// a custom portable routine that's almost the same                       
-   /// https://stackoverflow.com/questions/62962839                           
+   /// Alignment of the usable memory of pools, beyond the page alignment     
+   /// that every mapping has                                                 
+   #if LANGULUS_FRACTALLOC(ALIGNED_POOLS)
+      constexpr Offset PoolAlignment = Pool::DefaultPoolSize;
+   #elif LANGULUS_FRACTALLOC(HUGE_PAGES)
+      constexpr Offset PoolAlignment = HugePageSize;
+   #else
+      constexpr Offset PoolAlignment = 0;
+   #endif
+
+   /// Get the number of bytes mapped from the OS for a pool                  
+   ///   @param size - the usable bytes of the pool                           
+   ///   @return the byte size, rounded up to whole pages                     
+   LANGULUS(INLINED)
+   Offset GetPoolMappingSize(Offset size) noexcept {
+      return RoofToPage(Pool::GetNewAllocationSize(size) + PoolAlignment);
+   }
+
+   /// Map a pool directly from the OS, so that its pages are given back as   
+   /// soon as the pool is deallocated, regardless of what the heap thinks.   
+   /// Pages are mapped at page boundaries, that are always aligned enough    
+   /// for the Pool, and for any Allocation after it                          
+   ///                                                                        
+   /// [Pool::GetSize()][size bytes][occupancy bitmap][headers]               
+   ///                                                                        
+   /// With LANGULUS_FRACTALLOC(ALIGNED_POOLS) the usable memory is also      
+   /// placed on a DefaultPoolSize boundary. That is the natural alignment    
+   /// of default-sized pools. Bigger pools are multiples of it, so they      
+   /// still cover whole directory granules, while padding them to their own  
+   /// size would double their footprint. The padding is never touched, so    
+   /// it costs only address space                                            
+   /// With LANGULUS_FRACTALLOC(HUGE_PAGES) the usable memory is placed on    
+   /// a huge page boundary instead (unless already aligned further), and     
+   /// the OS is asked to back it with huge pages                             
    ///                                                                        
-   /// Each allocation has the following prefixed bytes:                      
-   /// [padding][T::GetSize()][client bytes...]                               
+   /// [padding][Pool][size bytes, aligned][bitmap][headers][padding]         
    ///                                                                        
-   ///   @param size - the number of client bytes to allocate                 
-   ///   @return a newly allocated memory that is correctly aligned           
-   template<AllocationPrimitive T>
-   T* AlignedAllocate(DMeta hint, Offset size) IF_UNSAFE(noexcept) {
-      const auto finalSize = T::GetNewAllocationSize(size) + Alignment;
-      const auto base = ::std::malloc(finalSize);
+   ///   @attention the pool isn't in the directory, see PublishPool          
+   ///   @param hint - optional meta data to associate pool with              
+   ///   @param size - the usable bytes of the pool, must be a power-of-two   
+   ///   @return the new pool, or nullptr if out of memory                    
+   Pool* Allocator::MapPool(DMeta hint, Offset size) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, IsPowerOfTwo(size) and size >= Pool::DefaultPoolSize,
+         "Pool size must be a power-of-two, not smaller than the default");
+
+      const auto base = MapPages(GetPoolMappingSize(size));
       if (not base)
          return nullptr;
 
-      // Align pointer to the alignment LANGULUS was built with         
-      auto ptr = reinterpret_cast<T*>(
-         (reinterpret_cast<Offset>(base) + Alignment)
-         & ~(Alignment - Offset {1})
-      );
+      Pool* ptr;
+      if constexpr (PoolAlignment) {
+         const auto memory = (reinterpret_cast<Offset>(base) + Pool::GetSize() + PoolAlignment - 1)
+            & ~(PoolAlignment - Offset {1});
+         ptr = reinterpret_cast<Pool*>(memory - Pool::GetSize());
+      }
+      else ptr = static_cast<Pool*>(base);
+
+      #if LANGULUS_FRACTALLOC(HUGE_PAGES)
+         // The advice must be given before the pool touches its pages  
+         const bool huge = AdviseHugePages(reinterpret_cast<Byte*>(ptr) + Pool::GetSize(), size);
+      #else
+         const bool huge = false;
+      #endif
 
-      // Place the entry there                                          
-      new (ptr) T {hint, size, base};
+      new (ptr) Pool {hint, size, base};
+      ptr->mHugePages = huge;
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         const auto start = ::std::chrono::steady_clock::now();
+      #endif
+
+      // The usable memory, extended to whole pages                     
+      const auto page = GetPageSize();
+      const auto from = reinterpret_cast<Pointer>(ptr->mMemory) & ~(page - 1);
+      const auto pages = reinterpret_cast<void*>(from);
+      const auto bytes = RoofToPage(reinterpret_cast<Pointer>(ptr->mMemoryEnd)) - from;
+
+      bool committed = false;
+      switch (Instance.mCommitPolicy.load(::std::memory_order_relaxed)) {
+      case CommitPolicy::Populate:
+         committed = PopulatePages(pages, bytes);
+         break;
+      case CommitPolicy::Lock:
+         committed = LockPages(pages, bytes);
+         break;
+      case CommitPolicy::Lazy:
+         committed = true;
+         break;
+      case CommitPolicy::Touch:
+         break;
+      }
+
+      if (not committed)
+         ptr->Touch();
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         ptr->mCommitTime = ::std::chrono::steady_clock::now() - start;
+      #endif
       return ptr;
    }
 
    /// Global allocator interface                                             
    Allocator Instance {};
 
+   /// Stop the provisioner, because a running thread can't outlive us, and   
+   /// give the reserved pools back to the OS                                 
+   Allocator::~Allocator() {
+      StopProvisioner();
+      StopTrimmers();
+
+      const ::std::scoped_lock lock {mMutex};
+      TrimReserve(0, 0);
+   }
+
 #if VERBOSE_ENABLED()
    void Allocator::DumpAllocation(RTTI::DMeta hint, const Pool* pool, const Allocation* memory) noexcept {
       VERBOSE_TAB(
          "Fractalloc: ", Logger::Green, "New allocation ", Logger::Hex(memory),
-         " of size ", Size {memory->mAllocatedBytes}, ", in pool ", Logger::Hex(pool)
+         " of size ", Size {memory->GetAllocatedSize()}, ", in pool ", Logger::Hex(pool)
       );
 
       if (hint) {
@@ -93,7 +179,7 @@ namespace Langulus::Fractalloc
       for (Offset entry = 0; entry < pool->mEntries; ++entry) {
          auto a = pool->AllocationFromIndex(entry);
          if (a->GetUses()) {
-            auto start = (reinterpret_cast<const char*>(a)
+            auto start = (reinterpret_cast<const char*>(pool->BlockFromIndex(entry))
                        -  reinterpret_cast<const char*>(pool->GetPoolStart()))
                        / bytesPerChar;
             auto end   = start + a->GetTotalSize() / bytesPerChar;
@@ -122,40 +208,337 @@ namespace Langulus::Fractalloc
    }
 #endif
 
+   /// Each thread keeps its claimed pools here                               
+   thread_local ThreadCache LocalCache {};
+
+   /// Register the cache of a thread, when the thread first uses it          
+   ThreadCache::ThreadCache() {
+      Instance.RegisterCache(*this);
+   }
+
+   /// Give all claimed pools back to their chains, when thread exits         
+   ThreadCache::~ThreadCache() {
+      Instance.ReleaseCache(*this);
+   }
+
+   /// Get the size pool chain for a type with PoolTactic::Size               
+   /// Types are grouped by their size, rounded up to a power-of-two. Pools   
+   /// of small sizes are slabs, that hold a single element per entry, so     
+   /// bigger requests, such as arrays, go to the main chain instead          
+   ///   @param hint - the type                                               
+   ///   @param bytes - the entry size, including the Allocation overhead     
+   ///   @return the index in mSizePoolChain, or Pool::InvalidIndex if the    
+   ///      request doesn't fit in the slabs of the type                      
+   LANGULUS(INLINED)
+   Offset Allocator::SizeBucket(DMeta hint, Offset bytes) noexcept {
+      const auto bucket = Offset(::std::bit_width(
+         ::std::max(Offset {hint->mSize}, Offset {1}) - 1));
+      const auto slot = Chain::SlabSize(bucket);
+      return slot and bytes > slot ? Pool::InvalidIndex : bucket;
+   }
+
+   /// Get a key, that identifies the pool chain for a type, based on its     
+   /// pool tactic. Doesn't access the chain, so it is safe without locking   
+   /// and even if the chain of a type wasn't made yet                        
+   /// Requests aligned beyond Alignment are chained by alignment instead     
+   ///   @param hint - optional meta data to decide chain                     
+   ///   @param bytes - the entry size, including the Allocation overhead     
+   ///   @param alignment - the alignment of the client memory                
+   ///   @return the key of the chain                                         
+   const void* Allocator::ChainKey(DMeta hint, Offset bytes, Offset alignment) noexcept {
+      if (alignment > Alignment)
+         return &Instance.mAlignedPoolChain[::std::countr_zero(alignment)];
+
+      if (hint) {
+         switch (hint->mPoolTactic) {
+         case RTTI::PoolTactic::Size: {
+            const auto bucket = SizeBucket(hint, bytes);
+            if (bucket == Pool::InvalidIndex)
+               break;
+            return &Instance.mSizePoolChain[bucket];
+         }
+         case RTTI::PoolTactic::Type:
+            return &hint->GetPool<Chain>();
+         case RTTI::PoolTactic::Main:
+            break;
+         }
+      }
+      return &Instance.mMainPoolChain;
+   }
+
+   /// Get the pool chain for a type, based on its pool tactic                
+   /// Types with PoolTactic::Type get their chain on first use               
+   /// Requests aligned beyond Alignment are chained by alignment instead     
+   ///   @attention must be called under lock                                 
+   ///   @param hint - optional meta data to decide chain                     
+   ///   @param bytes - the entry size, including the Allocation overhead     
+   ///   @param alignment - the alignment of the client memory                
+   ///   @return the chain, or nullptr if out of memory                       
+   Chain* Allocator::ChainOf(DMeta hint, Offset bytes, Offset alignment) noexcept {
+      if (alignment > Alignment) {
+         // The chain keeps its pools aligned                           
+         auto& chain = mAlignedPoolChain[::std::countr_zero(alignment)];
+         chain.mAlignment = alignment;
+         return &chain;
+      }
+
+      if (hint) {
+         switch (hint->mPoolTactic) {
+         case RTTI::PoolTactic::Size: {
+            const auto bucket = SizeBucket(hint, bytes);
+            if (bucket == Pool::InvalidIndex)
+               break;
+
+            // The chain makes slabs, unless its elements are too big   
+            auto& chain = mSizePoolChain[bucket];
+            chain.mSlot = Chain::SlabSize(bucket);
+            return &chain;
+         }
+         case RTTI::PoolTactic::Type: {
+            auto& chain = hint->GetPool<Chain>();
+            if (not chain) {
+               chain = new (::std::nothrow) Chain {};
+               if (chain) {
+                  // Types with big allocation pages start with bigger  
+                  // pools, so that each pool holds many pages, as long 
+                  // as the pools remain within Pool::MaxPoolSize       
+                  chain->mPoolSizeMin = chain->mPoolSize = ::std::min(::std::max(
+                     Pool::DefaultPoolSize, Roof2(hint->mAllocationPage.mSize * Chain::MinPages)),
+                     Pool::MaxPoolSize);
+                  chain->mPoolSizeMax = ::std::min(
+                     chain->mPoolSizeMin * Chain::MaxGrowth, Pool::MaxPoolSize);
+                  mInstantiatedTypes.insert(&*hint);
+               }
+            }
+            return chain;
+         }
+         case RTTI::PoolTactic::Main:
+            break;
+         }
+      }
+      return &mMainPoolChain;
+   }
+
+   /// Sort an unclaimed pool back into its chain, after it has changed       
+   ///   @attention must be called under lock                                 
+   ///   @param pool - the pool to sort                                       
+   LANGULUS(INLINED)
+   void Allocator::SortPool(Pool* pool) noexcept {
+      // Pools made directly with Allocator::AllocatePool aren't in any 
+      // chain                                                          
+      if (pool->mChain)
+         pool->mChain->Sort(pool);
+   }
+
    /// Allocate a memory entry                                                
+   /// Entries aligned beyond Alignment are kept in pools of their own, that  
+   /// place them on multiples of the alignment, and pad their headers, see   
+   /// Pool::MakeAligned. They remain reference-counted, and can be found     
+   /// like any other entry                                                   
    ///   @attention doesn't call any constructors                             
    ///   @attention doesn't throw - check if return is nullptr                
    ///   @attention assumes size is not zero                                  
    ///   @param hint - optional meta data to associate pool with              
    ///   @param size - the number of bytes to allocate                        
+   ///   @param alignment - the alignment of the client memory, a             
+   ///      power-of-two                                                      
    ///   @return the allocation, or nullptr if out of memory                  
-   Allocation* Allocator::Allocate(RTTI::DMeta hint, Offset size) IF_UNSAFE(noexcept) {
+   Allocation* Allocator::Allocate(RTTI::DMeta hint, Offset size, Offset alignment)
+   IF_UNSAFE(noexcept) {
       LANGULUS_ASSUME(DevAssumes, size, "Zero allocation is not allowed");
+      LANGULUS_ASSUME(DevAssumes, IsPowerOfTwo(alignment),
+         "Alignment must be a power-of-two");
+
+      // Compact headers can't describe all sizes                       
+      if constexpr (LANGULUS_FRACTALLOC(COMPACT_HEADERS)) {
+         if (size > Allocation::MaxBytes)
+            return nullptr;
+      }
+
+      // Requests that don't fit in a default pool bypass the pools     
+      const auto bytes = Pool::GetAlignedAllocationSize(size, alignment);
+      if (bytes > LargeBlock::Threshold)
+         return Instance.AllocateLarge(hint, size, alignment);
 
       // Decide pool chain, based on hint                               
-      Pool* pool = nullptr;
-      if (hint) {
-         switch (hint->mPoolTactic) {
-         case RTTI::PoolTactic::Size:
-            pool = Instance.mSizePoolChain[Inner::FastLog2(hint->mSize)];
-            break;
-         case RTTI::PoolTactic::Type:
-            pool = hint->GetPool<Pool>();
-            break;
-         case RTTI::PoolTactic::Main:
-            pool = Instance.mMainPoolChain;
-            break;
+      const auto chain = ChainKey(hint, bytes, alignment);
+
+      // Attempt to place allocation in the pool, that this thread      
+      // has claimed from the chain - no locking required               
+      const auto& slot = LocalCache.SlotOf(chain);
+      if (slot.mChain == chain and slot.mPool) {
+         const auto memory = slot.mPool->Allocate(size);
+         if (memory) {
+            #if VERBOSE_ENABLED()
+               DumpAllocation(hint, slot.mPool, memory);
+            #endif
+
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               LocalCache.mEntries += 1;
+               LocalCache.mBytesAllocatedByFrontend += memory->GetTotalSize();
+            #endif
+
+            return memory;
+         }
+      }
+
+      // If reached, the claimed pool can't contain the memory          
+      const ::std::scoped_lock lock {Instance.mMutex};
+      return Instance.AllocateSlow(hint, chain, size, alignment);
+   }
+
+   /// Allocate many memory entries of the same size at once                  
+   /// The claimed pool is filled without locking, and the lock is taken at   
+   /// most once, for whatever it couldn't contain. Statistics are updated    
+   /// once per pool, instead of once per entry                               
+   ///   @attention doesn't call any constructors                             
+   ///   @attention doesn't throw - check the returned count                  
+   ///   @attention assumes size is not zero                                  
+   ///   @param hint - optional meta data to associate pools with             
+   ///   @param size - the number of bytes to allocate for each entry         
+   ///   @param result - [out] the new entries; the ones that couldn't be     
+   ///      allocated are set to nullptr                                      
+   ///   @param alignment - the alignment of the client memory, a             
+   ///      power-of-two                                                      
+   ///   @return the number of entries allocated, from the front of result    
+   Count Allocator::AllocateBatch(
+      RTTI::DMeta hint, Offset size, ::std::span<Allocation*> result, Offset alignment
+   ) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, size, "Zero allocation is not allowed");
+      LANGULUS_ASSUME(DevAssumes, IsPowerOfTwo(alignment),
+         "Alignment must be a power-of-two");
+
+      // Compact headers can't describe all sizes                       
+      if constexpr (LANGULUS_FRACTALLOC(COMPACT_HEADERS)) {
+         if (size > Allocation::MaxBytes) {
+            ::std::fill(result.begin(), result.end(), nullptr);
+            return 0;
+         }
+      }
+
+      Count done = 0;
+      const auto bytes = Pool::GetAlignedAllocationSize(size, alignment);
+      if (bytes > LargeBlock::Threshold) {
+         // Large blocks have nothing to share with each other          
+         while (done < result.size()) {
+            const auto memory = Instance.AllocateLarge(hint, size, alignment);
+            if (not memory)
+               break;
+            result[done++] = memory;
          }
       }
-      else pool = Instance.mMainPoolChain;
+      else {
+         const auto chain = ChainKey(hint, bytes, alignment);
+         const auto& slot = LocalCache.SlotOf(chain);
+
+         // Fill as much as possible from the pool, that this thread    
+         // has claimed from the chain - no locking required            
+         const auto fill = [&] {
+            if (slot.mChain != chain or not slot.mPool)
+               return;
+
+            const auto count = slot.mPool->AllocateBatch(size, result.subspan(done));
+            if (not count)
+               return;
+
+            #if VERBOSE_ENABLED()
+               for (Count i = done; i < done + count; ++i)
+                  DumpAllocation(hint, slot.mPool, result[i]);
+            #endif
+
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               LocalCache.mEntries += count;
+               for (Count i = done; i < done + count; ++i)
+                  LocalCache.mBytesAllocatedByFrontend += result[i]->GetTotalSize();
+            #endif
+            done += count;
+         };
+
+         fill();
+
+         if (done < result.size()) {
+            // If reached, the claimed pool can't contain the rest      
+            // Each slow allocation claims a new pool, if it can, so    
+            // keep filling from it                                     
+            const ::std::scoped_lock lock {Instance.mMutex};
+            while (done < result.size()) {
+               const auto memory = Instance.AllocateSlow(hint, chain, size, alignment);
+               if (not memory)
+                  break;
+
+               result[done++] = memory;
+               fill();
+            }
+         }
+      }
+
+      ::std::fill(result.begin() + done, result.end(), nullptr);
+      return done;
+   }
+
+   /// Allocate many memory entries of the same size at once, into an array   
+   ///   @attention doesn't call any constructors                             
+   ///   @attention doesn't throw - check the returned count                  
+   ///   @attention assumes size is not zero                                  
+   ///   @param hint - optional meta data to associate pools with             
+   ///   @param size - the number of bytes to allocate for each entry         
+   ///   @param count - the number of entries to allocate                     
+   ///   @param result - [out] at least count entries; the ones that          
+   ///      couldn't be allocated are set to nullptr                          
+   ///   @param alignment - the alignment of the client memory, a             
+   ///      power-of-two                                                      
+   ///   @return the number of entries allocated, from the front of result    
+   Count Allocator::AllocateBatch(
+      RTTI::DMeta hint, Offset size, Count count, Allocation** result, Offset alignment
+   ) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, result or not count, "Nullptr provided");
+      return AllocateBatch(hint, size, ::std::span<Allocation*> {result, count}, alignment);
+   }
+
+   /// Allocate a memory entry, when thread cache can't satisfy request       
+   ///   @attention must be called under lock                                 
+   ///   @param hint - optional meta data to associate pool with              
+   ///   @param key - the key of the pool chain, as decided by the hint       
+   ///   @param size - the number of bytes to allocate                        
+   ///   @param alignment - the alignment of the client memory                
+   ///   @return the allocation, or nullptr if out of memory                  
+   Allocation* Allocator::AllocateSlow(DMeta hint, const void* key, Offset size, Offset alignment)
+   IF_UNSAFE(noexcept) {
+      FlushStatistics(LocalCache);
+
+      // Small requests claim the pool they're placed in, so that       
+      // subsequent allocations from this thread don't need locking     
+      auto& slot = LocalCache.SlotOf(key);
+      const auto bytes = Pool::GetAlignedAllocationSize(size, alignment);
+      const bool claim = bytes <= ThreadCache::LargeRequest;
 
-      //	Attempt to place allocation in the default chain               
       Allocation* memory = nullptr;
-      while (pool) {
-         memory = pool->Allocate(size);
-         if (memory)
-            break;
-         pool = pool->mNext;
+      if (claim and slot.mPool) {
+         if (slot.mChain == key) {
+            // Recycle entries freed by other threads, and retry        
+            slot.mPool->DrainRemote();
+            memory = slot.mPool->Allocate(size);
+         }
+
+         if (not memory) {
+            // Claimed pool is exhausted, or it is from another chain   
+            // that hashes to the same slot - give it back              
+            ReleasePool(slot.mPool);
+            slot = {};
+         }
+      }
+
+      const auto chain = ChainOf(hint, bytes, alignment);
+      if (not chain)
+         return nullptr;
+
+      // Attempt to place allocation in the shared pool with the least  
+      // space, that can still contain it - the chain keeps them sorted 
+      Pool* pool = slot.mPool;
+      if (not memory) {
+         pool = chain->Fetch(bytes);
+         if (pool)
+            memory = pool->Allocate(size);
       }
 
       if (memory) {
@@ -164,62 +547,358 @@ namespace Langulus::Fractalloc
          #endif
 
          #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-            auto& stats = Instance.mStatistics;
-            stats.mEntries += 1;
-            stats.mBytesAllocatedByFrontend += memory->GetTotalSize();
+            mStatistics.mEntries += 1;
+            mStatistics.mBytesAllocatedByFrontend += memory->GetTotalSize();
+         #endif
+      }
+      else {
+         // If reached, pool chain can't contain the memory             
+         // Reuse a reserved pool, take a spare one, or allocate a new  
+         // one, and add it at the front of hinted chain. Spares are    
+         // taken even if the chain wants a bigger pool, because they   
+         // are already committed                                       
+         const auto poolSize = ::std::max(chain->Grow(), Roof2(bytes));
+         pool = TakeReserved(poolSize);
+         if (pool) {
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               ++mStatistics.mReusedPools;
+            #endif
+         }
+         else if ((pool = TakeSpare(bytes))) {
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               ++mStatistics.mProvisionedPools;
+            #endif
+         }
+         else {
+            pool = MapPool(nullptr, poolSize);
+            if (not pool)
+               return nullptr;
+
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               ++mStatistics.mSynchronousPools;
+            #endif
+         }
+
+         VERBOSE(
+            "Fractalloc: ", Logger::Cyan, "New pool ", Logger::Hex(pool),
+            " of size ", Size {pool->GetAllocatedByBackend()}
+         );
+
+         // Type and size chains remember the type, so that Reallocate  
+         // can find the chain again. Pools can move between chains     
+         // through the reserve, so the type is always overwritten      
+         pool->mMeta = chain != &mMainPoolChain and not chain->mAlignment ? hint : nullptr;
+
+         if (chain->mSlot)
+            pool->MakeSlab(chain->mSlot);
+         else if (chain->mAlignment)
+            pool->MakeAligned(chain->mAlignment);
+
+         // The pool can be searched only after its layout is decided   
+         if (not PublishPool(pool))
+            return nullptr;
+         memory = pool->Allocate(size);
+
+         #if VERBOSE_ENABLED()
+            DumpAllocation(hint, pool, memory);
+         #endif
+
+         chain->Link(pool);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            mStatistics.AddPool(pool);
          #endif
+      }
 
-         return memory;
+      if (claim and not slot.mPool) {
+         // Claimed pools are never offered to other threads            
+         chain->Detach(pool);
+         pool->mOwner.store(&LocalCache, ::std::memory_order_relaxed);
+         pool->OpenRemote();
+         slot = {key, pool};
+      }
+      else if (pool != slot.mPool)
+         chain->Sort(pool);
+
+      // Wake up the provisioner, if no unclaimed pool in the chain has 
+      // a quarter of a default pool left                               
+      if (mSpareCount < mSpareTarget
+      and not chain->Fetch(Pool::DefaultPoolSize / 4)) {
+         mSparesWanted = true;
+         mProvisionerSignal.notify_one();
       }
 
-      // If reached, pool chain can't contain the memory                
-      // Allocate a new pool and add it at the front of hinted chain    
-      pool = AllocatePool(nullptr, Allocation::GetNewAllocationSize(size));
-      if (not pool)
+      return memory;
+   }
+
+   /// Take a spare pool, prepared by the provisioner                         
+   ///   @attention must be called under lock                                 
+   ///   @param bytes - the entry size, including the Allocation overhead     
+   ///   @return the pool, or nullptr if there are no spares, or if the       
+   ///      entry doesn't fit in a default-sized pool                         
+   Pool* Allocator::TakeSpare(Offset bytes) noexcept {
+      if (not mSpares or bytes > Pool::DefaultPoolSize)
+         return nullptr;
+
+      const auto pool = mSpares;
+      mSpares = pool->mNext;
+      pool->mNext = nullptr;
+      --mSpareCount;
+      return pool;
+   }
+
+   /// Take an empty pool from the reserve, and make it new again             
+   ///   @attention must be called under lock                                 
+   ///   @attention the pool isn't in the directory, see PublishPool          
+   ///   @param size - the size of the usable memory of the pool, must be a   
+   ///      power-of-two                                                      
+   ///   @return the pool, or nullptr if no reserved pool has that size       
+   Pool* Allocator::TakeReserved(Offset size) IF_UNSAFE(noexcept) {
+      auto link = &mReserve;
+      while (*link and (*link)->mAllocatedByBackend < size)
+         link = &(*link)->mNext;
+
+      const auto pool = *link;
+      if (not pool or pool->mAllocatedByBackend != size)
          return nullptr;
 
+      *link = pool->mNext;
+      --mReserveCount;
+      mReserveBytes -= size;
+      ++mReserveHits;
+
+      // The pages are already mapped and committed                     
+      const bool huge = pool->mHugePages;
+      new (pool) Pool {nullptr, size, pool->mHandle};
+      pool->mHugePages = huge;
+      return pool;
+   }
+
+   /// Keep an empty pool in the reserve, instead of deallocating it          
+   /// The biggest reserved pools are deallocated, if limits are exceeded     
+   ///   @attention must be called under lock                                 
+   ///   @attention pool must not be in any chain, nor in the directory,      
+   ///      and no search may still see it, see DiscardPool                   
+   ///   @param pool - the pool to reserve                                    
+   void Allocator::ReservePool(Pool* pool) IF_UNSAFE(noexcept) {
+      auto link = &mReserve;
+      while (*link and (*link)->mAllocatedByBackend < pool->mAllocatedByBackend)
+         link = &(*link)->mNext;
+
+      pool->mNext = *link;
+      *link = pool;
+      ++mReserveCount;
+      mReserveBytes += pool->mAllocatedByBackend;
+      TrimReserve(mReserveMaxCount, mReserveMaxBytes);
+   }
+
+   /// Deallocate the biggest reserved pools, until the reserve is within     
+   /// the given limits                                                       
+   ///   @attention must be called under lock                                 
+   ///   @param count - the max number of reserved pools                      
+   ///   @param bytes - the max number of reserved bytes                      
+   void Allocator::TrimReserve(Count count, Offset bytes) IF_UNSAFE(noexcept) {
+      while (mReserveCount > count or mReserveBytes > bytes) {
+         auto link = &mReserve;
+         while ((*link)->mNext)
+            link = &(*link)->mNext;
+
+         const auto pool = *link;
+         *link = nullptr;
+         --mReserveCount;
+         mReserveBytes -= pool->mAllocatedByBackend;
+
+         // Already removed from the directory                          
+         UnmapPages(pool->mHandle, GetPoolMappingSize(pool->mAllocatedByBackend));
+      }
+   }
+
+   /// The body of the provisioner thread                                     
+   /// Sleeps until a chain nears exhaustion, and then makes spare pools      
+   /// outside the lock, so that committing their pages doesn't stall         
+   /// the allocating threads                                                 
+   void Allocator::Provision() {
+      ::std::unique_lock lock {mMutex};
+      while (mSpareTarget) {
+         if (not mSparesWanted or mSpareCount >= mSpareTarget) {
+            mSparesWanted = false;
+            mProvisionerSignal.wait(lock);
+            continue;
+         }
+
+         // Spares aren't in the directory, until they're taken         
+         lock.unlock();
+         const auto pool = MapPool(nullptr, Pool::DefaultPoolSize);
+         lock.lock();
+
+         if (not pool) {
+            // Out of memory - wait until spares are wanted again       
+            mSparesWanted = false;
+            continue;
+         }
+
+         pool->mNext = mSpares;
+         mSpares = pool;
+         ++mSpareCount;
+      }
+   }
+
+   /// Map a large block directly from the OS, for a request that doesn't     
+   /// fit in a default pool                                                  
+   ///   @param hint - optional meta data to associate block with             
+   ///   @param size - the number of bytes to allocate                        
+   ///   @param alignment - the alignment of the client memory                
+   ///   @return the allocation, or nullptr if out of memory                  
+   Allocation* Allocator::AllocateLarge(DMeta hint, Offset size, Offset alignment)
+   IF_UNSAFE(noexcept) {
+      const auto mapped = LargeBlock::GetNewAllocationSize(size, alignment);
+      const auto base = MapPages(mapped);
+      if (not base)
+         return nullptr;
+
+      // Shift the headers, so that the client memory after them is     
+      // aligned                                                        
+      const auto first = reinterpret_cast<Pointer>(base)
+         + LargeBlock::GetSize() + Allocation::GetSize();
+      const auto padding = (alignment - (first & (alignment - 1))) & (alignment - 1);
+      const auto block = reinterpret_cast<LargeBlock*>(static_cast<Byte*>(base) + padding);
+      new (block) LargeBlock {mapped, hint, base, alignment};
+      const auto memory = new (block->GetAllocation()) Allocation {
+         Allocation::GetNewAllocationSize(size) - Allocation::GetOverhead(), nullptr
+      };
+
       VERBOSE(
-         "Fractalloc: ", Logger::Cyan, "New pool ", Logger::Hex(pool),
-         " of size ", Size {pool->GetAllocatedByBackend()}
+         "Fractalloc: ", Logger::Cyan, "New large block ", Logger::Hex(block),
+         " of size ", Size {mapped}
       );
 
-      memory = pool->Allocate(size);
+      {
+         const ::std::unique_lock lock {mLargeMutex};
+         mLargeBlocks.insert(block);
+      }
 
-      #if VERBOSE_ENABLED()
-         DumpAllocation(hint, pool, memory);
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         const ::std::scoped_lock lock {mMutex};
+         mStatistics.mBytesAllocatedByBackend += mapped;
+         mStatistics.mBytesAllocatedByFrontend += memory->GetTotalSize();
+         mStatistics.mEntries += 1;
       #endif
+      return memory;
+   }
 
-      if (hint) {
-         switch (hint->mPoolTactic) {
-         case RTTI::PoolTactic::Size: {
-            auto& sizeChain = Instance.mSizePoolChain[Inner::FastLog2(hint->mSize)];
-            pool->mNext = sizeChain;
-            sizeChain = pool;
-            break;
-         }
-         case RTTI::PoolTactic::Type: {
-            auto& relevantPool = hint->GetPool<Pool>();
-            pool->mNext = relevantPool;
-            relevantPool = pool;
-            Instance.mInstantiatedTypes.insert(&*hint);
-            break;
-         }
-         case RTTI::PoolTactic::Main:
-            pool->mNext = Instance.mMainPoolChain;
-            Instance.mMainPoolChain = pool;
-            break;
+   /// Give a large block back to the OS                                      
+   ///   @attention assumes entry is in a large block                         
+   ///   @param entry - the entry of the block                                
+   void Allocator::DeallocateLarge(Allocation* entry) IF_UNSAFE(noexcept) {
+      const auto block = LargeBlock::From(entry);
+      const auto mapped = block->mMapped;
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+      {
+         const ::std::scoped_lock lock {mMutex};
+         mStatistics.mBytesAllocatedByBackend -= mapped;
+         mStatistics.mBytesAllocatedByFrontend -= entry->GetTotalSize();
+         mStatistics.mEntries -= 1;
+      }
+      #endif
+
+      {
+         // Searches hold the lock while reading the block              
+         const ::std::unique_lock lock {mLargeMutex};
+         LANGULUS_ASSUME(DevAssumes, mLargeBlocks.contains(block),
+            "Large block is not registered");
+         mLargeBlocks.erase(block);
+      }
+
+      UnmapPages(block->mHandle, mapped);
+   }
+
+   /// Give a claimed pool back to its chain                                  
+   ///   @attention must be called by the owner, under lock                   
+   ///   @param pool - the pool to release                                    
+   void Allocator::ReleasePool(Pool* pool) IF_UNSAFE(noexcept) {
+      // Threads that miss the last drain take the lock, and wait for   
+      // the pool to become unclaimed                                   
+      pool->CloseRemote();
+      pool->mOwner.store(nullptr, ::std::memory_order_relaxed);
+      SortPool(pool);
+      if (not pool->IsInUse())
+         ListEmpty(pool);
+   }
+
+   /// Add a thread cache to the list of all caches                           
+   ///   @param cache - the cache to register                                 
+   void Allocator::RegisterCache(ThreadCache& cache) {
+      const ::std::scoped_lock lock {mCachesMutex};
+      cache.mNextCache = mCaches;
+      if (mCaches)
+         mCaches->mPrevCache = &cache;
+      mCaches = &cache;
+   }
+
+   /// Give all pools claimed by a thread cache back to their chains, and     
+   /// remove the cache from the list of all caches                           
+   ///   @param cache - the cache to release                                  
+   void Allocator::ReleaseCache(ThreadCache& cache) IF_UNSAFE(noexcept) {
+      {
+         const ::std::scoped_lock lock {mMutex};
+         FlushStatistics(cache);
+
+         for (auto& slot : cache.mSlots) {
+            if (slot.mPool)
+               ReleasePool(slot.mPool);
+            slot = {};
          }
       }
-      else {
-         pool->mNext = Instance.mMainPoolChain;
-         Instance.mMainPoolChain = pool;
+
+      const ::std::scoped_lock lock {mCachesMutex};
+      if (cache.mPrevCache)
+         cache.mPrevCache->mNextCache = cache.mNextCache;
+      else
+         mCaches = cache.mNextCache;
+      if (cache.mNextCache)
+         cache.mNextCache->mPrevCache = cache.mPrevCache;
+   }
+
+   /// Wait until all searches by address, that might have found a pool       
+   /// before it was removed from the directory, are over, so that the pool   
+   /// can be reused or unmapped. Searches that begin later can't find it     
+   /// Searches count themselves, and then read mPoolEpoch, while this        
+   /// increments mPoolEpoch, and then reads the counters, all sequentially   
+   /// consistent - so either a search reads the new epoch, and with it the   
+   /// removal from the directory, or its count is seen here                  
+   /// Only the searches in progress right now are waited for, so a thread,   
+   /// that keeps searching, delays this by a single search at most           
+   ///   @attention the pool must already be removed from the directory,      
+   ///      and mPoolEpoch incremented, so that recent pools are forgotten    
+   void Allocator::WaitForSearches() noexcept {
+      const ::std::scoped_lock lock {mCachesMutex};
+      for (auto cache = mCaches; cache; cache = cache->mNextCache) {
+         const auto searches = cache->mSearches.load(::std::memory_order_seq_cst);
+         if (searches % 2 == 0)
+            continue;
+
+         // Any change means that search is over                        
+         while (cache->mSearches.load(::std::memory_order_acquire) == searches)
+            ::std::this_thread::yield();
       }
+   }
 
+   /// Merge the statistics accumulated by a thread cache                     
+   ///   @attention must be called under lock                                 
+   ///   @param cache - the cache to flush                                    
+   void Allocator::FlushStatistics(ThreadCache& cache) noexcept {
       #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-         Instance.mStatistics.AddPool(pool);
+         mStatistics.mEntries += cache.mEntries;
+         mStatistics.mBytesAllocatedByFrontend += cache.mBytesAllocatedByFrontend;
+         mStatistics.mFindHits += cache.mFindHits;
+         mStatistics.mFindMisses += cache.mFindMisses;
+         cache.mEntries = 0;
+         cache.mBytesAllocatedByFrontend = 0;
+         cache.mFindHits = 0;
+         cache.mFindMisses = 0;
+      #else
+         (void) cache;
       #endif
-
-      return memory;
    }
 
    /// Reallocate a memory entry                                              
@@ -245,161 +924,818 @@ namespace Langulus::Fractalloc
       LANGULUS_ASSUME(DevAssumes, previous->mReferences == 1,
          "Reallocating allocation used from multiple places");
 
-      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-         const auto oldSize = previous->GetTotalSize();
-      #endif
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         const auto oldSize = previous->GetTotalSize();
+      #endif
+
+      // New size is bigger, precautions must be taken                  
+      // Pools claimed by other threads can't be resized in place       
+      const auto pool = previous->GetPool();
+      if (not pool) {
+         // Large blocks are resized in place, as long as the pages     
+         // they already have are enough                                
+         const auto block = LargeBlock::From(previous);
+         if (size > block->GetCapacity())
+            return Allocate(block->mMeta, size, block->mAlignment);
+
+         // Whole pages past the new end are given back right away      
+         const auto mapped = block->mMapped;
+         const auto keep = RoofToPage(static_cast<Offset>(
+            previous->GetBlockStart() + size - static_cast<Byte*>(block->mHandle)));
+         if (keep < mapped) {
+            {
+               // Searches hold the lock while reading the block        
+               const ::std::unique_lock lock {Instance.mLargeMutex};
+               block->mMapped = keep;
+            }
+
+            TrimPages(block->mHandle, mapped, keep);
+
+            VERBOSE(
+               "Fractalloc: ", Logger::Cyan, "Large block ", Logger::Hex(block),
+               " was trimmed from ", Size {mapped}, " to ", Size {keep}
+            );
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const ::std::scoped_lock lock {Instance.mMutex};
+            auto& stats = Instance.mStatistics;
+            stats.mBytesAllocatedByBackend -= mapped - block->mMapped;
+            stats.mBytesAllocatedByFrontend -= oldSize;
+            stats.mBytesAllocatedByFrontend += Allocation::GetOverhead() + size;
+         #endif
+
+         previous->mAllocatedBytes = static_cast<decltype(previous->mAllocatedBytes)>(size);
+         return previous;
+      }
+
+      if (pool->mOwner.load(::std::memory_order_relaxed) == &LocalCache) {
+         if (pool->Reallocate(previous, size)) {
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               LocalCache.mBytesAllocatedByFrontend -= oldSize;
+               LocalCache.mBytesAllocatedByFrontend += previous->GetTotalSize();
+            #endif
+
+            VERBOSE(
+               "Fractalloc: ", Logger::Yellow, "Allocation ", Logger::Hex(previous),
+               " was reallocated from ", Size {as}, " to ", Size {size}
+            );
+            return previous;
+         }
+      }
+      else {
+         const ::std::scoped_lock lock {Instance.mMutex};
+         if (not pool->mOwner.load(::std::memory_order_relaxed)
+         and pool->Reallocate(previous, size)) {
+            SortPool(pool);
+
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               auto& stats = Instance.mStatistics;
+               stats.mBytesAllocatedByFrontend -= oldSize;
+               stats.mBytesAllocatedByFrontend += previous->GetTotalSize();
+            #endif
+
+            VERBOSE(
+               "Fractalloc: ", Logger::Yellow, "Allocation ", Logger::Hex(previous),
+               " was reallocated from ", Size {as}, " to ", Size {size}
+            );
+            return previous;
+         }
+      }
+
+      // If this is reached, we have a collision, so new entry is made  
+      // in the same chain, with the same alignment - the type of the   
+      // pool leads back to its chain, see AllocateSlow                 
+      return Allocate(pool->mMeta, size, ::std::max(pool->mAlignment, Offset {Alignment}));
+   }
+   
+   /// Deallocate a memory allocation                                         
+   /// Entries in pools claimed by other threads are queued without locking,  
+   /// and recycled by the owner thread in batches                            
+   ///   @attention assumes entry is a valid entry under jurisdiction         
+   ///   @attention doesn't call any destructors                              
+   ///   @param entry - the memory entry to deallocate                        
+   void Allocator::Deallocate(Allocation* entry) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, entry,
+         "Deallocating nullptr");
+      LANGULUS_ASSUME(DevAssumes, entry->GetAllocatedSize(),
+         "Deallocating an empty allocation");
+      LANGULUS_ASSUME(DevAssumes, entry->mReferences,
+         "Deallocating an unused allocation");
+      LANGULUS_ASSUME(DevAssumes, entry->mReferences == 1,
+         "Deallocating an allocation used from multiple places");
+
+      VERBOSE(
+         "Fractalloc: ", Logger::Red, "Allocation ", Logger::Hex(entry),
+         " of size ", Size {entry->GetAllocatedSize()}, " was deallocated"
+      );
+
+      const auto pool = entry->GetPool();
+      if (not pool) {
+         Instance.DeallocateLarge(entry);
+         return;
+      }
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         // The entry can't be touched after it is queued               
+         const auto bytes = entry->GetTotalSize();
+      #endif
+
+      const auto owner = pool->mOwner.load(::std::memory_order_relaxed);
+      if (owner == &LocalCache or (owner and pool->PushRemote(entry))) {
+         // Pool is claimed - no locking required                       
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            LocalCache.mBytesAllocatedByFrontend -= bytes;
+            LocalCache.mEntries -= 1;
+         #endif
+
+         if (owner == &LocalCache)
+            pool->Deallocate(entry);
+         return;
+      }
+
+      // If reached, the pool isn't claimed, or its owner is giving it  
+      // back right now, and no longer accepts entries                  
+      const ::std::scoped_lock lock {Instance.mMutex};
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         // Entries of pools made directly with AllocatePool aren't     
+         // counted. Region pools are always claimed, so never get here 
+         if (pool->mChain) {
+            auto& stats = Instance.mStatistics;
+            stats.mBytesAllocatedByFrontend -= bytes;
+            stats.mEntries -= 1;
+         }
+      #endif
+
+      // Claims change only under lock, so the pool accepts entries if  
+      // it's claimed again                                             
+      if (not pool->mOwner.load(::std::memory_order_relaxed) or not pool->PushRemote(entry)) {
+         pool->Deallocate(entry);
+         SortPool(pool);
+         if (not pool->IsInUse())
+            Instance.ListEmpty(pool);
+      }
+   }
+
+   /// Deallocate many memory allocations at once                             
+   /// Entries are grouped by pool, so that each pool is visited once: the    
+   /// entries for pools claimed by other threads are queued with a single    
+   /// exchange, the lock is taken at most once for all unclaimed pools, and  
+   /// statistics are updated once per pool                                   
+   ///   @attention assumes all entries are valid entries under jurisdiction  
+   ///   @attention reorders the entries                                      
+   ///   @attention doesn't call any destructors                              
+   ///   @param entries - the memory entries to deallocate                    
+   void Allocator::DeallocateBatch(::std::span<Allocation*> entries) IF_UNSAFE(noexcept) {
+      for (auto entry : entries) {
+         LANGULUS_ASSUME(DevAssumes, entry,
+            "Deallocating nullptr");
+         LANGULUS_ASSUME(DevAssumes, entry->GetAllocatedSize(),
+            "Deallocating an empty allocation");
+         LANGULUS_ASSUME(DevAssumes, entry->mReferences,
+            "Deallocating an unused allocation");
+         LANGULUS_ASSUME(DevAssumes, entry->mReferences == 1,
+            "Deallocating an allocation used from multiple places");
+
+         VERBOSE(
+            "Fractalloc: ", Logger::Red, "Allocation ", Logger::Hex(entry),
+            " of size ", Size {entry->GetAllocatedSize()}, " was deallocated"
+         );
+      }
+
+      // Large blocks take the lock on their own, so get rid of them    
+      // before anything else                                           
+      const auto pooled = ::std::partition(entries.begin(), entries.end(),
+         [](const Allocation* entry) { return not entry->GetPool(); });
+      for (auto entry = entries.begin(); entry != pooled; ++entry)
+         Instance.DeallocateLarge(*entry);
+
+      // Group the rest by pool                                         
+      ::std::sort(pooled, entries.end(), [](const Allocation* lhs, const Allocation* rhs) {
+         return ::std::less<const Pool*> {}(lhs->GetPool(), rhs->GetPool());
+      });
+
+      ::std::unique_lock lock {Instance.mMutex, ::std::defer_lock};
+      for (auto first = pooled; first != entries.end();) {
+         const auto pool = (*first)->GetPool();
+         const auto last = ::std::find_if(first + 1, entries.end(),
+            [pool](const Allocation* entry) { return entry->GetPool() != pool; });
+         const ::std::span<Allocation*> run {first, last};
+         first = last;
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            Offset bytes = 0;
+            for (auto entry : run)
+               bytes += entry->GetTotalSize();
+         #endif
+
+         const auto owner = pool->mOwner.load(::std::memory_order_relaxed);
+         if (owner == &LocalCache or (owner and pool->PushRemote(run))) {
+            // Pool is claimed - no locking required                    
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               LocalCache.mBytesAllocatedByFrontend -= bytes;
+               LocalCache.mEntries -= run.size();
+            #endif
+
+            if (owner == &LocalCache) {
+               for (auto entry : run)
+                  pool->Deallocate(entry);
+            }
+            continue;
+         }
+
+         // If reached, the pool isn't claimed, or its owner is giving  
+         // it back right now, and no longer accepts entries            
+         if (not lock.owns_lock())
+            lock.lock();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            if (pool->mChain) {
+               auto& stats = Instance.mStatistics;
+               stats.mBytesAllocatedByFrontend -= bytes;
+               stats.mEntries -= run.size();
+            }
+         #endif
+
+         if (not pool->mOwner.load(::std::memory_order_relaxed) or not pool->PushRemote(run)) {
+            for (auto entry : run)
+               pool->Deallocate(entry);
+            SortPool(pool);
+            if (not pool->IsInUse())
+               Instance.ListEmpty(pool);
+         }
+      }
+   }
+
+   /// Allocate a pool, and register it in the pool directory                 
+   ///   @attention the pool must be deallocated with DeallocatePool          
+   ///   @param hint - optional meta data to associate pool with              
+   ///   @param size - size of the pool (in bytes)                            
+   ///   @return a pointer to the new pool, or nullptr if out of memory, or   
+   ///      if size is bigger than Pool::MaxPoolSize                          
+   Pool* Allocator::AllocatePool(DMeta hint, Offset size) IF_UNSAFE(noexcept) {
+      if (size > Pool::MaxPoolSize)
+         return nullptr;
+
+      const auto pool = MapPool(hint, ::std::max(Pool::DefaultPoolSize, Roof2(size)));
+      return pool and PublishPool(pool) ? pool : nullptr;
+   }
+
+   /// Allocate a pool for a Region, and register it in the pool directory    
+   /// The pool is filled like a stack, see Pool::MakeBump, and is claimed    
+   /// by Region::Owner, so that Deallocate queues its entries from any       
+   /// thread, and the region recycles them, when it bumps or resets          
+   ///   @attention the pool must be deallocated with DeallocatePool          
+   ///   @param hint - optional meta data to associate pool with              
+   ///   @param size - size of the pool (in bytes)                            
+   ///   @return a pointer to the new pool, or nullptr if out of memory, or   
+   ///      if size is bigger than Pool::MaxPoolSize                          
+   Pool* Allocator::AllocateBumpPool(DMeta hint, Offset size) IF_UNSAFE(noexcept) {
+      if (size > Pool::MaxPoolSize)
+         return nullptr;
+
+      const auto pool = MapPool(hint, ::std::max(Pool::DefaultPoolSize, Roof2(size)));
+      if (not pool)
+         return nullptr;
+
+      // Nobody else sees the pool until it is published                
+      pool->MakeBump();
+      pool->mOwner.store(Region::Owner(), ::std::memory_order_relaxed);
+      pool->OpenRemote();
+      return PublishPool(pool) ? pool : nullptr;
+   }
+
+   /// Register a new pool in the pool directory, so that it can be searched  
+   /// The pool is deallocated, if it can't be registered                     
+   ///   @attention the pool must not be modified by any other thread until   
+   ///      this returns, except by searches                                  
+   ///   @param pool - the pool to register                                   
+   ///   @return true if registered, false if out of memory                   
+   bool Allocator::PublishPool(Pool* pool) IF_UNSAFE(noexcept) {
+      if (Instance.mDirectory.Insert(pool))
+         return true;
+
+      // A pool, that can't be found, can't be used                     
+      UnmapPages(pool->mHandle, GetPoolMappingSize(pool->mAllocatedByBackend));
+      return false;
+   }
+
+   /// Deallocate a pool                                                      
+   ///   @attention doesn't call any destructors                              
+   ///   @attention pool or any entry inside is no longer valid after this    
+   ///   @attention assumes pool is a valid pointer                           
+   ///   @param pool - the pool to deallocate                                 
+   void Allocator::DeallocatePool(Pool* pool) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, pool, "Nullptr provided");
+      Instance.mDirectory.Remove(pool);
+      Instance.mPoolEpoch.fetch_add(1, ::std::memory_order_seq_cst);
+      Instance.WaitForSearches();
+      UnmapPages(pool->mHandle, GetPoolMappingSize(pool->mAllocatedByBackend));
+   }
+
+   /// Change how new pools are committed                                     
+   /// Pools that already exist are not affected                              
+   ///   @param policy - the new policy                                       
+   void Allocator::SetCommitPolicy(CommitPolicy policy) noexcept {
+      Instance.mCommitPolicy.store(policy, ::std::memory_order_relaxed);
+   }
+
+   /// Get how new pools are committed                                        
+   ///   @return the current policy                                           
+   CommitPolicy Allocator::GetCommitPolicy() noexcept {
+      return Instance.mCommitPolicy.load(::std::memory_order_relaxed);
+   }
+
+   /// Start a background thread, that prepares spare pools, whenever a pool  
+   /// chain nears exhaustion. Allocating threads then just link a spare in,  
+   /// instead of making and committing a new pool on the spot                
+   /// Calling this while the provisioner runs just changes the spare count   
+   ///   @attention don't call concurrently with StopProvisioner              
+   ///   @param spares - number of default-sized pools to keep prepared,      
+   ///      zero stops the provisioner                                        
+   ///   @return true if the provisioner is running                           
+   bool Allocator::StartProvisioner(Count spares) {
+      if (not spares) {
+         StopProvisioner();
+         return false;
+      }
+
+      {
+         const ::std::scoped_lock lock {Instance.mMutex};
+         Instance.mSpareTarget = spares;
+         Instance.mSparesWanted = true;
+      }
+
+      if (Instance.mProvisioner.joinable()) {
+         Instance.mProvisionerSignal.notify_one();
+         return true;
+      }
+
+      try {
+         Instance.mProvisioner = ::std::thread {&Allocator::Provision, &Instance};
+      }
+      catch (const ::std::system_error&) {
+         const ::std::scoped_lock lock {Instance.mMutex};
+         Instance.mSpareTarget = 0;
+         return false;
+      }
+
+      return true;
+   }
+
+   /// Stop the provisioner thread, if running, and deallocate all spares     
+   ///   @attention don't call concurrently with StartProvisioner             
+   void Allocator::StopProvisioner() {
+      {
+         const ::std::scoped_lock lock {Instance.mMutex};
+         Instance.mSpareTarget = 0;
+      }
+
+      Instance.mProvisionerSignal.notify_one();
+      if (Instance.mProvisioner.joinable())
+         Instance.mProvisioner.join();
+
+      const ::std::scoped_lock lock {Instance.mMutex};
+      while (Instance.mSpares) {
+         // Spares were never in the directory                          
+         const auto pool = Instance.mSpares;
+         Instance.mSpares = pool->mNext;
+         UnmapPages(pool->mHandle, GetPoolMappingSize(pool->mAllocatedByBackend));
+      }
+      Instance.mSpareCount = 0;
+   }
+
+   /// Change the limits of the reserve of empty pools. Instead of giving     
+   /// unused pools back to the OS, CollectGarbage keeps them, so that        
+   /// workloads, that oscillate between bursts of allocations and garbage    
+   /// collections, don't make and commit the same pools over and over        
+   /// The reserve decays by half with each CollectGarbage, that finds none   
+   /// of its pools taken since the previous one                              
+   ///   @param pools - max number of reserved pools, zero disables reserve   
+   ///   @param bytes - max number of usable bytes in all reserved pools      
+   void Allocator::SetReserve(Count pools, Offset bytes) IF_UNSAFE(noexcept) {
+      const ::std::scoped_lock lock {Instance.mMutex};
+      Instance.mReserveMaxCount = pools;
+      Instance.mReserveMaxBytes = bytes;
+      Instance.TrimReserve(pools, bytes);
+   }
+
+   /// Visit the pools of a chain, that weren't visited in the current        
+   /// collection pass yet. Unused pools are released right away, while       
+   /// pools in use are claimed and gathered in a batch, to be trimmed        
+   /// outside the lock. Pools claimed by other threads are skipped           
+   ///   @attention must be called under lock                                 
+   ///   @param chain - [in/out] the chain                                    
+   ///   @param key - the key of the chain, see ChainKey                      
+   ///   @param batch - [out] the pools to trim                               
+   ///   @param limit - the max number of pools in batch                      
+   ///   @param progress - [in/out] the progress to update                    
+   ///   @param discarded - [in/out] the released pools, see DiscardPool      
+   ///   @return true if the whole chain was visited, false if batch is full  
+   bool Allocator::CollectGarbageChain(
+      Chain& chain, const void* key, ::std::vector<Pool*>& batch,
+      Count limit, GarbageProgress& progress, Pool*& discarded
+   ) {
+      auto& slot = LocalCache.SlotOf(key);
+      auto link = &chain.mPools;
+      while (*link) {
+         const auto pool = *link;
+         const auto owner = pool->mOwner.load(::std::memory_order_relaxed);
+         if (pool->mCollectPass == mCollectPass
+         or (owner and owner != &LocalCache)) {
+            // Pool was already visited, or is claimed by another       
+            // thread, so leave it alone                                
+            link = &pool->mNext;
+            continue;
+         }
+
+         if (batch.size() == limit)
+            return false;
+
+         pool->mCollectPass = mCollectPass;
+         ++progress.mVisited;
+
+         pool->DrainRemote();
+         if (pool->IsInUse()) {
+            if (owner)
+               pool->Trim();
+            else {
+               // Claim the pool, so that it can be trimmed without     
+               // locking - other threads will free to it remotely      
+               chain.Detach(pool);
+               pool->mOwner.store(&LocalCache, ::std::memory_order_relaxed);
+               pool->OpenRemote();
+               batch.push_back(pool);
+            }
+            link = &pool->mNext;
+            continue;
+         }
+
+         if (owner) {
+            slot = {};
+            pool->CloseRemote();
+            pool->mOwner.store(nullptr, ::std::memory_order_relaxed);
+         }
+
+         DiscardPool(pool, discarded);
+         ++progress.mReleased;
+      }
+
+      return true;
+   }
+
+   /// Remove an unused pool from its chain and from the directory, and       
+   /// gather it with the other discarded pools. They can be reserved only    
+   /// once no search can see them, which is waited for outside the lock,     
+   /// see ReserveDiscarded                                                   
+   ///   @attention must be called under lock                                 
+   ///   @attention assumes pool is in a chain, and isn't claimed             
+   ///   @param pool - the pool to discard                                    
+   ///   @param discarded - [in/out] the discarded pools, linked through      
+   ///      Pool::mNext                                                       
+   void Allocator::DiscardPool(Pool* pool, Pool*& discarded) IF_UNSAFE(noexcept) {
+      UnlistEmpty(pool);
+      pool->mChain->Detach(pool);
+      pool->mChain->Shrink();
+      pool->mChain->Unlink(pool);
+
+      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+         mStatistics.DelPool(pool);
+      #endif
+
+      VERBOSE(
+         "Fractalloc: ", Logger::DarkCyan, "Pool ", Logger::Hex(pool),
+         " of size ", Size {pool->GetAllocatedByBackend()}, " was released"
+      );
+
+      // Reserved pools aren't ours, until they're taken again          
+      mDirectory.Remove(pool);
+      pool->mNext = discarded;
+      discarded = pool;
+   }
+
+   /// Reserve the pools, gathered by DiscardPool, once no search can see     
+   /// them anymore. The lock is released while searches are waited for, so   
+   /// that they don't stall the threads that allocate in the meantime        
+   ///   @attention must be called under lock, that is released and taken     
+   ///      again, if there's anything to reserve                             
+   ///   @param lock - the lock of mMutex                                     
+   ///   @param discarded - [in/out] the discarded pools, emptied after this  
+   void Allocator::ReserveDiscarded(::std::unique_lock<::std::mutex>& lock, Pool*& discarded)
+   IF_UNSAFE(noexcept) {
+      if (not discarded)
+         return;
 
-      // New size is bigger, precautions must be taken                  
-      if (previous->mPool->Reallocate(previous, size)) {
-         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-            auto& stats = Instance.mStatistics;
-            stats.mBytesAllocatedByFrontend -= oldSize;
-            stats.mBytesAllocatedByFrontend += previous->GetTotalSize();
-         #endif
+      lock.unlock();
+      mPoolEpoch.fetch_add(1, ::std::memory_order_seq_cst);
+      WaitForSearches();
+      lock.lock();
 
-         VERBOSE(
-            "Fractalloc: ", Logger::Yellow, "Allocation ", Logger::Hex(previous),
-            " was reallocated from ", Size {as}, " to ", Size {size}
-         );
-         return previous;
+      while (discarded) {
+         const auto next = discarded->mNext;
+         ReservePool(discarded);
+         discarded = next;
       }
+   }
 
-      // If this is reached, we have a collision, so new entry is made  
-      return Allocate(previous->mPool->mMeta, size);
+   /// Remember an unclaimed pool, that became empty, so that it can be       
+   /// released without visiting the rest of the heap                         
+   ///   @attention must be called under lock                                 
+   ///   @param pool - the pool to remember                                   
+   void Allocator::ListEmpty(Pool* pool) noexcept {
+      // Pools made directly with Allocator::AllocatePool aren't in any 
+      // chain, and are never collected                                 
+      if (pool->mEmptyListed or not pool->mChain)
+         return;
+
+      pool->mEmptyPrev = nullptr;
+      pool->mEmptyNext = mEmptyPools;
+      if (mEmptyPools)
+         mEmptyPools->mEmptyPrev = pool;
+      mEmptyPools = pool;
+      pool->mEmptyListed = true;
    }
-   
-   /// Deallocate a memory allocation                                         
-   ///   @attention assumes entry is a valid entry under jurisdiction         
-   ///   @attention doesn't call any destructors                              
-   ///   @param entry - the memory entry to deallocate                        
-   void Allocator::Deallocate(Allocation* entry) IF_UNSAFE(noexcept) {
-      LANGULUS_ASSUME(DevAssumes, entry,
-         "Deallocating nullptr");
-      LANGULUS_ASSUME(DevAssumes, entry->GetAllocatedSize(),
-         "Deallocating an empty allocation");
-      LANGULUS_ASSUME(DevAssumes, entry->mReferences,
-         "Deallocating an unused allocation");
-      LANGULUS_ASSUME(DevAssumes, entry->mReferences == 1,
-         "Deallocating an allocation used from multiple places");
 
-      VERBOSE(
-         "Fractalloc: ", Logger::Red, "Allocation ", Logger::Hex(entry),
-         " of size ", Size {entry->GetAllocatedSize()}, " was deallocated"
-      );
+   /// Forget a pool, that was remembered as empty                            
+   ///   @attention must be called under lock                                 
+   ///   @param pool - the pool to forget                                     
+   void Allocator::UnlistEmpty(Pool* pool) noexcept {
+      if (not pool->mEmptyListed)
+         return;
 
-      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-         auto& stats = Instance.mStatistics;
-         stats.mBytesAllocatedByFrontend -= entry->GetTotalSize();
-         stats.mEntries -= 1;
-      #endif
+      if (pool->mEmptyPrev)
+         pool->mEmptyPrev->mEmptyNext = pool->mEmptyNext;
+      else
+         mEmptyPools = pool->mEmptyNext;
+
+      if (pool->mEmptyNext)
+         pool->mEmptyNext->mEmptyPrev = pool->mEmptyPrev;
 
-      entry->mPool->Deallocate(entry);
+      pool->mEmptyNext = pool->mEmptyPrev = nullptr;
+      pool->mEmptyListed = false;
    }
 
-   /// Allocate a pool                                                        
-   ///   @attention the pool must be deallocated with DeallocatePool          
-   ///   @param hint - optional meta data to associate pool with              
-   ///   @param size - size of the pool (in bytes)                            
-   ///   @return a pointer to the new pool                                    
-   Pool* Allocator::AllocatePool(DMeta hint, Offset size) IF_UNSAFE(noexcept) {
-      const auto poolSize = ::std::max(Pool::DefaultPoolSize, Roof2(size));
-      return AlignedAllocate<Pool>(hint, poolSize);
+   /// Start a new collection pass from the first chain                       
+   ///   @attention must be called under lock                                 
+   void Allocator::BeginCollection() {
+      // Let the reserve decay, if nothing was taken from it since the  
+      // previous collection                                            
+      if (not mReserveHits)
+         TrimReserve(mReserveCount / 2, mReserveMaxBytes);
+      mReserveHits = 0;
+
+      // Type chains are visited in the order they had at the start     
+      mCollectTypes.assign(mInstantiatedTypes.begin(), mInstantiatedTypes.end());
+      mCollectChain = 0;
+      ++mCollectPass;
+      mCollecting = true;
    }
 
-   /// Deallocate a pool                                                      
-   ///   @attention doesn't call any destructors                              
-   ///   @attention pool or any entry inside is no longer valid after this    
-   ///   @attention assumes pool is a valid pointer                           
-   ///   @param pool - the pool to deallocate                                 
-   void Allocator::DeallocatePool(Pool* pool) IF_UNSAFE(noexcept) {
-      LANGULUS_ASSUME(DevAssumes, pool, "Nullptr provided");
-      ::std::free(pool->mHandle);
+   /// Continue the current collection pass, from the chain it stopped at     
+   /// The main chain is first, then all size chains, then all aligned        
+   /// chains, then all type chains                                           
+   ///   @attention must be called under lock                                 
+   ///   @param batch - [out] the pools to trim                               
+   ///   @param limit - the max number of pools in batch                      
+   ///   @param progress - [in/out] the progress to update                    
+   ///   @param discarded - [in/out] the released pools, see DiscardPool      
+   ///   @return true if the pass is complete                                 
+   bool Allocator::CollectStep(
+      ::std::vector<Pool*>& batch, Count limit, GarbageProgress& progress, Pool*& discarded
+   ) {
+      const auto chains = 1 + SizeBuckets + AlignmentBuckets + mCollectTypes.size();
+      for (; mCollectChain < chains; ++mCollectChain) {
+         if (mCollectChain == 0) {
+            if (not CollectGarbageChain(mMainPoolChain, &mMainPoolChain, batch, limit, progress, discarded))
+               return false;
+            continue;
+         }
+
+         if (mCollectChain <= SizeBuckets) {
+            auto& sizeChain = mSizePoolChain[mCollectChain - 1];
+            if (not CollectGarbageChain(sizeChain, &sizeChain, batch, limit, progress, discarded))
+               return false;
+            continue;
+         }
+
+         if (mCollectChain <= SizeBuckets + AlignmentBuckets) {
+            auto& alignedChain = mAlignedPoolChain[mCollectChain - 1 - SizeBuckets];
+            if (not CollectGarbageChain(alignedChain, &alignedChain, batch, limit, progress, discarded))
+               return false;
+            continue;
+         }
+
+         // Types might have been discarded since the pass started      
+         const auto type = mCollectTypes[mCollectChain - 1 - SizeBuckets - AlignmentBuckets];
+         if (not mInstantiatedTypes.contains(type))
+            continue;
+
+         auto& relevantChain = type->GetPool<Chain>();
+         if (not CollectGarbageChain(*relevantChain, &relevantChain, batch, limit, progress, discarded))
+            return false;
+
+         // Also discard the chain and the type if no pools remain      
+         if (not relevantChain->mPools) {
+            delete relevantChain;
+            relevantChain = nullptr;
+            mInstantiatedTypes.erase(type);
+         }
+      }
+
+      mCollecting = false;
+      return true;
    }
 
-   /// Deallocates all unused pools in a chain                                
-   ///   @param chainStart - [in/out] the start of the chain                  
-   void Allocator::CollectGarbageChain(Pool*& chainStart) {
-      while (chainStart) {
-         if (chainStart->IsInUse()) {
-            chainStart->Trim();
-            break;
+   /// Trim a batch of claimed pools, optionally with the help of trimmer     
+   /// threads. Trimmers are started on first demand, and are kept for the    
+   /// batches after, so that collecting doesn't spend its time budget on     
+   /// starting threads. They help one collecting thread at a time - the      
+   /// others trim their batches on their own                                 
+   ///   @param batch - the pools to trim                                     
+   ///   @param workers - the number of threads to use, including this one    
+   void Allocator::TrimBatch(::std::span<Pool* const> batch, Count workers) {
+      ::std::atomic<Count> alone {};
+      auto next = &alone;
+
+      if (workers > 1 and batch.size() > 1) {
+         const ::std::scoped_lock lock {mTrimMutex};
+         if (mTrimBatch.empty() and not mTrimBusy and not mTrimStop) {
+            // Trimmers that fail to start leave more work for the rest 
+            while (mTrimmers.size() < workers - 1) {
+               try { mTrimmers.emplace_back(&Allocator::HelpTrim, this); }
+               catch (const ::std::system_error&) { break; }
+            }
+
+            if (not mTrimmers.empty()) {
+               mTrimBatch = batch;
+               mTrimNext.store(0, ::std::memory_order_relaxed);
+               mTrimHelpers = ::std::min(workers, Count {batch.size()}) - 1;
+               next = &mTrimNext;
+            }
          }
+      }
 
-         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-            mStatistics.DelPool(chainStart);
-         #endif
+      if (next == &mTrimNext)
+         mTrimSignal.notify_all();
 
-         auto next = chainStart->mNext;
-         VERBOSE(
-            "Fractalloc: ", Logger::DarkCyan, "Pool ", Logger::Hex(chainStart),
-            " of size ", Size {chainStart->GetAllocatedByBackend()}, " was deallocated"
-         );
-         DeallocatePool(chainStart);
-         chainStart = next;
+      for (auto i = (*next)++; i < batch.size(); i = (*next)++)
+         batch[i]->Trim();
+
+      if (next == &mTrimNext) {
+         // Withdraw the batch, so that no more trimmers join, and wait 
+         // for the ones that did                                       
+         ::std::unique_lock lock {mTrimMutex};
+         mTrimBatch = {};
+         mTrimDone.wait(lock, [this] { return not mTrimBusy; });
       }
+   }
 
-      if (not chainStart)
-         return;
+   /// The body of a trimmer thread                                           
+   /// Sleeps until a collecting thread hands out a batch, and helps it trim  
+   /// the pools in it                                                        
+   void Allocator::HelpTrim() {
+      ::std::unique_lock lock {mTrimMutex};
+      while (true) {
+         mTrimSignal.wait(lock, [this] {
+            return mTrimStop or (mTrimHelpers and not mTrimBatch.empty());
+         });
+         if (mTrimStop)
+            return;
+
+         const auto batch = mTrimBatch;
+         --mTrimHelpers;
+         ++mTrimBusy;
+         lock.unlock();
+
+         for (auto i = mTrimNext++; i < batch.size(); i = mTrimNext++)
+            batch[i]->Trim();
+
+         lock.lock();
+         if (not --mTrimBusy)
+            mTrimDone.notify_one();
+      }
+   }
 
-      auto prev = chainStart;
-      auto pool = chainStart->mNext;
-      while (pool) {
-         if (pool->IsInUse()) {
-            pool->Trim();
-            prev = pool;
-            pool = pool->mNext;
-            continue;
+   /// Stop all trimmer threads, if any                                       
+   void Allocator::StopTrimmers() {
+      {
+         const ::std::scoped_lock lock {mTrimMutex};
+         mTrimStop = true;
+      }
+
+      mTrimSignal.notify_all();
+      for (auto& thread : mTrimmers)
+         thread.join();
+      mTrimmers.clear();
+   }
+
+   /// Give a batch of trimmed pools back to their chains                     
+   ///   @attention must be called under lock                                 
+   ///   @param batch - the pools to release                                  
+   void Allocator::ReleaseBatch(::std::span<Pool* const> batch) IF_UNSAFE(noexcept) {
+      for (auto pool : batch)
+         ReleasePool(pool);
+   }
+
+   /// Collect garbage incrementally, within a time budget                    
+   /// Each call resumes the collection pass where the previous call          
+   /// stopped, and a pass visits each pool once. Unused pools are released,  
+   /// and pools in use are trimmed in batches, outside the lock, and         
+   /// optionally in parallel. Calling this from several threads at once      
+   /// also cooperates on the same pass                                       
+   ///   @param budget - time after which no new batch is started; at least   
+   ///      one batch is always processed, so that progress is made           
+   ///   @param workers - number of threads to trim pools with, including     
+   ///      the calling one; the others are kept for the next calls           
+   ///   @return the progress made                                            
+   auto Allocator::CollectGarbage(::std::chrono::nanoseconds budget, Count workers)
+   -> GarbageProgress {
+      const auto start = ::std::chrono::steady_clock::now();
+      const auto limit = ::std::max(workers, Count {1}) * CollectBatch;
+      GarbageProgress progress;
+      ::std::vector<Pool*> batch;
+      batch.reserve(limit);
+
+      while (true) {
+         {
+            ::std::unique_lock lock {Instance.mMutex};
+            Instance.FlushStatistics(LocalCache);
+            Instance.ReleaseBatch(batch);
+            batch.clear();
+
+            if (progress.mDone or (progress.mVisited
+            and ::std::chrono::steady_clock::now() - start >= budget)) {
+               progress.mChain = Instance.mCollectChain;
+               progress.mChains = 1 + SizeBuckets + AlignmentBuckets
+                  + Instance.mCollectTypes.size();
+               return progress;
+            }
+
+            if (not Instance.mCollecting)
+               Instance.BeginCollection();
+            Pool* discarded = nullptr;
+            progress.mDone = Instance.CollectStep(batch, limit, progress, discarded);
+            Instance.ReserveDiscarded(lock, discarded);
          }
 
-         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-            mStatistics.DelPool(pool);
-         #endif
+         Instance.TrimBatch(batch, workers);
+      }
+   }
 
-         const auto next = pool->mNext;
-         VERBOSE(
-            "Fractalloc: ", Logger::DarkCyan, "Pool ", Logger::Hex(pool),
-            " of size ", Size {pool->GetAllocatedByBackend()}, " was deallocated"
-         );
-         DeallocatePool(pool);
-         prev->mNext = next;
-         pool = next;
+   /// Release only the pools, that became empty since they were last         
+   /// collected, without visiting the rest of the heap. Cheap enough to be   
+   /// called often. Unlike CollectGarbage, pools in use aren't trimmed,      
+   /// and empty type chains aren't discarded                                 
+   ///   @return the number of released pools                                 
+   Count Allocator::CollectEmptyPools() {
+      ::std::unique_lock lock {Instance.mMutex};
+      Instance.FlushStatistics(LocalCache);
+
+      Count released = 0;
+      Pool* discarded = nullptr;
+      while (Instance.mEmptyPools) {
+         const auto pool = Instance.mEmptyPools;
+         Instance.UnlistEmpty(pool);
+
+         // The pool might have been claimed, or reused since           
+         if (pool->mOwner.load(::std::memory_order_relaxed) or pool->IsInUse())
+            continue;
+
+         Instance.DiscardPool(pool, discarded);
+         ++released;
       }
+
+      Instance.ReserveDiscarded(lock, discarded);
+      return released;
    }
-   
+
    /// Deallocates all unused pools                                           
    ///   @return true if there's at least one pool remaining allocated        
    bool Allocator::CollectGarbage() {
-      bool result = false;
-      Instance.mLastFoundPool = nullptr;
+      {
+         // Start a new pass, so that every pool is visited             
+         const ::std::scoped_lock lock {Instance.mMutex};
+         Instance.mCollecting = false;
+      }
 
-      // Cleanup the main chain                                         
-      Instance.CollectGarbageChain(Instance.mMainPoolChain);
-      if (Instance.mMainPoolChain)
-         result = true;
+      UNUSED() const auto progress = CollectGarbage(::std::chrono::nanoseconds::max());
+
+      const ::std::scoped_lock lock {Instance.mMutex};
+      if (Instance.mMainPoolChain.mPools or not Instance.mInstantiatedTypes.empty())
+         return true;
 
-      // Cleanup all size chains                                        
       for (auto& sizeChain : Instance.mSizePoolChain) {
-         Instance.CollectGarbageChain(sizeChain);
-         if (sizeChain)
-            result = true;
+         if (sizeChain.mPools)
+            return true;
       }
 
-      // Cleanup all type chains                                        
-      auto& types = Instance.mInstantiatedTypes;
-      for (auto typeChain =  types.begin(); typeChain != types.end();) {
-         auto& relevantPool = (*typeChain)->GetPool<Pool>();
-         Instance.CollectGarbageChain(relevantPool);
-
-         // Also discard the type if no pools remain                    
-         if (not relevantPool)
-            typeChain = types.erase(typeChain);
-         else {
-            ++typeChain;
-            result = true;
-         }
+      for (auto& alignedChain : Instance.mAlignedPoolChain) {
+         if (alignedChain.mPools)
+            return true;
       }
 
-      return result;
+      return false;
    }
    
 #if LANGULUS_FEATURE(MANAGED_REFLECTION)
@@ -409,10 +1745,11 @@ namespace Langulus::Fractalloc
    ///   @param boundary - the boundary name                                  
    ///   @return the number of pools                                          
    Count Allocator::CheckBoundary(const Token& boundary) noexcept {
+      const ::std::scoped_lock lock {Instance.mMutex};
       Count count = 0;
       for (auto type : Instance.mInstantiatedTypes) {
          if (type->mLibraryName == boundary) {
-            auto pool = type->GetPool<Pool>();
+            auto pool = type->GetPool<Chain>()->mPools;
             while (pool) {
                ++count;
                pool = pool->mNext;
@@ -423,266 +1760,160 @@ namespace Langulus::Fractalloc
    }
 #endif
 
-   /// Search in a pool chain                                                 
+   /// Find the pool that contains an address                                 
+   /// Searches the recently found pools of the thread first, and falls       
+   /// back to the pool directory on a miss. Takes no locks                   
+   ///   @attention must be called during a ThreadCache::Search of the        
+   ///      thread, and the pool must not be used after the search is over    
    ///   @param memory - memory pointer                                       
-   ///   @param pool - start of the pool chain                                
-   ///   @return the memory entry that contains the memory pointer, or        
-   ///           nullptr if memory is not ours, its entry is no longer used   
-   const Allocation* Allocator::FindInChain(const void* memory, const Pool* pool) const IF_UNSAFE(noexcept) {
-      while (pool) {
-         const auto found = pool->Find(memory);
-         if (found) {
-            mLastFoundPool = pool;
-            return found;
-         }
-
-         // Continue inside the poolchain                               
-         pool = pool->mNext;
+   ///   @return the pool, or nullptr if memory is not ours                   
+   const Pool* Allocator::FindPool(const void* memory) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes,
+         LocalCache.mSearches.load(::std::memory_order_relaxed) % 2 == 1,
+         "Pool searched outside of ThreadCache::Search");
+      const auto epoch = mPoolEpoch.load(::std::memory_order_seq_cst);
+      auto pool = LocalCache.FindRecent(memory, epoch);
+      if (pool) {
+         IF_LANGULUS_MEMORY_STATISTICS(++LocalCache.mFindHits);
+         return pool;
       }
 
-      return nullptr;
+      IF_LANGULUS_MEMORY_STATISTICS(++LocalCache.mFindMisses);
+      pool = mDirectory.Find(memory);
+      if (pool)
+         LocalCache.AddRecent(memory, pool);
+      return pool;
    }
-   
-   /// Search if memory is contained inside a pool chain                      
-   ///   @param memory - memory pointer                                       
-   ///   @param pool - start of the pool chain                                
-   ///   @return true if we have authority over the memory                    
-   bool Allocator::ContainedInChain(const void* memory, const Pool* pool) const IF_UNSAFE(noexcept) {
-      while (pool) {
-         if (pool->Contains(memory))
-            return true;
 
-         // Continue inside the poolchain                               
-         pool = pool->mNext;
-      }
+   /// Find the large block that contains an address                          
+   ///   @attention the caller must hold mLargeMutex, at least shared, for    
+   ///      as long as it uses the block                                      
+   ///   @param memory - memory pointer                                       
+   ///   @return the block, or nullptr if memory is not in any large block    
+   const LargeBlock* Allocator::FindLarge(const void* memory) const noexcept {
+      auto block = mLargeBlocks.upper_bound(static_cast<const LargeBlock*>(memory));
+      if (block == mLargeBlocks.begin())
+         return nullptr;
 
-      return false;
+      --block;
+      return (*block)->Contains(memory) ? *block : nullptr;
    }
 
    /// Find a memory entry from pointer                                       
    /// Allows us to safely interface unknown memory, possibly reusing it      
-   /// Optimized for consecutive searches in near memory                      
-   ///   @param hint - the type of data to search for (optional)              
-   ///                 always provide hint for optimal performance            
+   /// The pool is found through the thread's recently found pools, or the    
+   /// pool directory, so the cost doesn't depend on the number of pools,     
+   /// or the number of instantiated types. No locks are taken, unless the    
+   /// memory isn't in any pool, and large blocks have to be searched         
+   /// Any pool can be searched, even one claimed by another thread           
+   ///   @attention the result is meaningful only if the entry, that contains 
+   ///      memory, isn't deallocated or resized by another thread meanwhile  
+   ///   @param hint - the type of data to search for (unused, the pool       
+   ///                 directory covers all pool chains at once)              
    ///   @param memory - memory pointer                                       
    ///   @return the memory entry that contains the memory pointer, or        
    ///           nullptr if memory is not ours, its entry is no longer used   
-   const Allocation* Allocator::Find(DMeta hint, const void* memory) IF_UNSAFE(noexcept) {
-      // Scan the last pool that found something (hot region)           
-      //TODO consider a whole stack of those?
-      if (Instance.mLastFoundPool) {
-         const auto found = Instance.mLastFoundPool->Find(memory);
-         if (found)
-            return found;
+   const Allocation* Allocator::Find(DMeta, const void* memory) IF_UNSAFE(noexcept) {
+      {
+         const ThreadCache::Search search {LocalCache};
+         const auto pool = Instance.FindPool(memory);
+         if (pool)
+            return pool->Find(memory);
       }
 
-      // Decide pool chains, based on hint                              
-      const Allocation* result;
-      if (hint) {
-         switch (hint->mPoolTactic) {
-         case RTTI::PoolTactic::Size: {
-            // Hint is sized, so check in size pool chain first         
-            const auto sizebucket = Inner::FastLog2(hint->mSize);
-            result = Instance.FindInChain(memory, Instance.mSizePoolChain[sizebucket]);
-            if (result)
-               return result;
-
-            // Then check default pool chain                            
-            // (pointer could be a member of default-pooled type)       
-            result = Instance.FindInChain(memory, Instance.mMainPoolChain);
-            if (result)
-               return result;
-
-            // Check all typed pool chains                              
-            // (pointer could be a member of type-pooled type)          
-            for (auto& type : Instance.mInstantiatedTypes) {
-               result = Instance.FindInChain(memory, type->GetPool<Pool>());
-               if (result)
-                  return result;
-            }
-
-            // Finally, check all other size pool chains                
-            // (pointer could be a member of differently sized type)    
-            for (Offset i = 0; i < sizebucket; ++i) {
-               result = Instance.FindInChain(memory, Instance.mSizePoolChain[i]);
-               if (result)
-                  return result;
-            }
-            for (Offset i = sizebucket + 1; i < SizeBuckets; ++i) {
-               result = Instance.FindInChain(memory, Instance.mSizePoolChain[i]);
-               if (result)
-                  return result;
-            }
-         } return nullptr;
+      const ::std::shared_lock lock {Instance.mLargeMutex};
+      const auto block = Instance.FindLarge(memory);
+      return block ? block->Find(memory) : nullptr;
+   }
 
-         case RTTI::PoolTactic::Type: {
-            // Hint is typed, so check in its typed pool chain first    
-            result = Instance.FindInChain(memory, hint->GetPool<Pool>());
-            if (result)
-               return result;
-
-            // Then check default pool chain                            
-            // (pointer could be a member of default-pooled type)       
-            result = Instance.FindInChain(memory, Instance.mMainPoolChain);
-            if (result)
-               return result;
-
-            // Check all size pool chains                               
-            // (pointer could be a member of a size-pooled type)        
-            for (auto& sizepool : Instance.mSizePoolChain) {
-               result = Instance.FindInChain(memory, sizepool);
-               if (result)
-                  return result;
+   /// Find the memory entries of many pointers at once                       
+   /// Resolves pools for a whole block of pointers before resolving any      
+   /// entries inside them, so that the independent directory and header      
+   /// loads can overlap. Pools are resolved in order of directory granules,  
+   /// so pointers into the same pool resolve it only once per block, even    
+   /// if they're interleaved with pointers into other pools. Like Find,      
+   /// this takes no locks for pools, and the large block lock is taken at    
+   /// most once, for all pointers outside pools                              
+   ///   @param hint - the type of data to search for (unused, the pool       
+   ///                 directory covers all pool chains at once)              
+   ///   @param memory - the memory pointers                                  
+   ///   @param result - [out] the entries that contain each pointer, in the  
+   ///      same order; nullptr for pointers that are not ours, or whose      
+   ///      entries are no longer used                                        
+   void Allocator::FindBatch(
+      DMeta, ::std::span<const void* const> memory, ::std::span<const Allocation*> result
+   ) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, result.size() >= memory.size(),
+         "Not enough space for results");
+      const ThreadCache::Search search {LocalCache};
+      ::std::shared_lock large {Instance.mLargeMutex, ::std::defer_lock};
+
+      constexpr Count Block = 16;
+      const Pool* pools[Block];
+      Count order[Block];
+      const Pool* last = nullptr;
+
+      for (Count start = 0; start < memory.size(); start += Block) {
+         const auto count = ::std::min(Block, Count {memory.size() - start});
+         const auto granule = [&](Count i) {
+            return reinterpret_cast<Pointer>(memory[start + i]) >> PoolDirectory::GranuleBits;
+         };
+
+         // Group the block by granule, so that each pool is met once   
+         for (Count i = 0; i < count; ++i)
+            order[i] = i;
+         ::std::sort(order, order + count, [&](Count lhs, Count rhs) {
+            return granule(lhs) < granule(rhs);
+         });
+
+         // Resolve the pools for the whole block first                 
+         for (Count i = 0; i < count; ++i) {
+            const auto at = order[i];
+            const auto ptr = memory[start + at];
+            if (last and last->Contains(ptr)) {
+               pools[at] = last;
+               continue;
             }
 
-            // Finally, check all type pool chains                      
-            // (pointer could be a member of a type-pooled type)        
-            for (auto& typepool : Instance.mInstantiatedTypes) {
-               if (typepool == hint)
-                  continue;
+            pools[at] = Instance.FindPool(ptr);
+            if (pools[at])
+               last = pools[at];
+         }
 
-               result = Instance.FindInChain(memory, typepool->GetPool<Pool>());
-               if (result)
-                  return result;
+         // Then resolve the entries inside them - pointers outside     
+         // pools might still be in a large block                       
+         for (Count i = 0; i < count; ++i) {
+            const auto ptr = memory[start + i];
+            if (pools[i])
+               result[start + i] = pools[i]->Find(ptr);
+            else {
+               if (not large.owns_lock())
+                  large.lock();
+               const auto block = Instance.FindLarge(ptr);
+               result[start + i] = block ? block->Find(ptr) : nullptr;
             }
-
-         } return nullptr;
-
-         case RTTI::PoolTactic::Main:
-            break;
          }
       }
-
-      // If reached, either no hint is provided, or PoolTactic::Main    
-      // Check main pool chain                                          
-      result = Instance.FindInChain(memory, Instance.mMainPoolChain);
-      if (result)
-         return result;
-
-      // Check all size pool chains                                     
-      // (pointer could be a member of a size-pooled type)              
-      for (auto& sizepool : Instance.mSizePoolChain) {
-         result = Instance.FindInChain(memory, sizepool);
-         if (result)
-            return result;
-      }
-
-      // Finally, check all type pool chains                            
-      // (pointer could be a member of a type-pooled type)              
-      for (auto& typepool : Instance.mInstantiatedTypes) {
-         result = Instance.FindInChain(memory, typepool->GetPool<Pool>());
-         if (result)
-            return result;
-      }
-
-      // If reahced, then memory is guaranteed to not be ours           
-      return nullptr;
    }
 
    /// Check if memory is owned by the memory manager                         
    /// Unlike Allocator::Find, this doesn't check if memory is currently used 
    /// but returns true, as long as the required pool is still available      
    ///   @attention assumes memory is a valid pointer                         
-   ///   @param hint - the type of data to search for (optional)              
+   ///   @param hint - the type of data to search for (unused, the pool       
+   ///                 directory covers all pool chains at once)              
    ///   @param memory - memory pointer                                       
    ///   @return true if we own the memory                                    
-   bool Allocator::CheckAuthority(DMeta hint, const void* memory) IF_UNSAFE(noexcept) {
+   bool Allocator::CheckAuthority(DMeta, const void* memory) IF_UNSAFE(noexcept) {
       LANGULUS_ASSUME(DevAssumes, memory, "Nullptr provided");
-
-      // Scan the last pool that found something (hot region)           
-      //TODO consider a whole stack of those?
-      if (Instance.mLastFoundPool) {
-         const auto found = Instance.mLastFoundPool->Find(memory);
-         if (found)
-            return found;
-      }
-
-      // Decide pool chains, based on hint                              
-      if (hint) {
-         switch (hint->mPoolTactic) {
-         case RTTI::PoolTactic::Size: {
-            // Hint is sized, so check in size pool chain first         
-            const auto sizebucket = Inner::FastLog2(hint->mSize);
-            if (Instance.ContainedInChain(memory, Instance.mSizePoolChain[sizebucket]))
-               return true;
-
-            // Then check default pool chain                            
-            // (pointer could be a member of default-pooled type)       
-            if (Instance.ContainedInChain(memory, Instance.mMainPoolChain))
-               return true;
-
-            // Check all typed pool chains                              
-            // (pointer could be a member of type-pooled type)          
-            for (auto& type : Instance.mInstantiatedTypes) {
-               if (Instance.ContainedInChain(memory, type->GetPool<Pool>()))
-                  return true;
-            }
-
-            // Finally, check all other size pool chains                
-            // (pointer could be a member of differently sized type)    
-            for (Offset i = 0; i < sizebucket; ++i) {
-               if (Instance.ContainedInChain(memory, Instance.mSizePoolChain[i]))
-                  return true;
-            }
-            for (Offset i = sizebucket + 1; i < SizeBuckets; ++i) {
-               if (Instance.ContainedInChain(memory, Instance.mSizePoolChain[i]))
-                  return true;
-            }
-         } return false;
-
-         case RTTI::PoolTactic::Type:
-            // Hint is typed, so check in its typed pool chain first    
-            if (Instance.ContainedInChain(memory, hint->GetPool<Pool>()))
-               return true;
-
-            // Then check default pool chain                            
-            // (pointer could be a member of default-pooled type)       
-            if (Instance.ContainedInChain(memory, Instance.mMainPoolChain))
-               return true;
-
-            // Check all size pool chains                               
-            // (pointer could be a member of a size-pooled type)        
-            for (auto& sizepool : Instance.mSizePoolChain) {
-               if (Instance.ContainedInChain(memory, sizepool))
-                  return true;
-            }
-
-            // Finally, check all type pool chains                      
-            // (pointer could be a member of a type-pooled type)        
-            for (auto& typepool : Instance.mInstantiatedTypes) {
-               if (typepool == hint)
-                  continue;
-
-               if (Instance.ContainedInChain(memory, typepool->GetPool<Pool>()))
-                  return true;
-            }
-            return false;
-
-         case RTTI::PoolTactic::Main:
-            break;
-         }
-      }
-
-      // If reached, either no hint is provided, or PoolTactic::Main    
-      // Check main pool chain                                          
-      if (Instance.ContainedInChain(memory, Instance.mMainPoolChain))
-         return true;
-
-      // Check all size pool chains                                     
-      // (pointer could be a member of a size-pooled type)              
-      for (auto& sizepool : Instance.mSizePoolChain) {
-         if (Instance.ContainedInChain(memory, sizepool))
-            return true;
-      }
-
-      // Finally, check all type pool chains                            
-      // (pointer could be a member of a type-pooled type)              
-      for (auto& typepool : Instance.mInstantiatedTypes) {
-         if (Instance.ContainedInChain(memory, typepool->GetPool<Pool>()))
+      {
+         const ThreadCache::Search search {LocalCache};
+         if (Instance.FindPool(memory))
             return true;
       }
 
-      return false;
+      const ::std::shared_lock lock {Instance.mLargeMutex};
+      return Instance.FindLarge(memory);
    }
    
 #if LANGULUS_FEATURE(MEMORY_STATISTICS)
@@ -716,7 +1947,7 @@ namespace Langulus::Fractalloc
             DumpPools();
             Diff(mState.value());
             mState = GetStatistics();
-            ++Instance.mStatistics.mStep;
+            NextStep();
             Logger::Error("Memory state mismatch");
             return false;
          }
@@ -724,16 +1955,46 @@ namespace Langulus::Fractalloc
 
       // All is fine                                                    
       mState = GetStatistics();
-      ++Instance.mStatistics.mStep;
+      NextStep();
       return true;
    }
+
+   /// Advance the step, that new pools are stamped with, so that Diff can    
+   /// tell which pools appeared since the last assertion                     
+   void Allocator::State::NextStep() noexcept {
+      const ::std::scoped_lock lock {Instance.mMutex};
+      ++Instance.mStatistics.mStep;
+   }
    
    /// Get allocator statistics                                               
-   ///   @return a reference to the statistics structure                      
-   auto Allocator::GetStatistics() noexcept -> const Statistics& {
+   /// The counters of the calling thread are flushed first, but other        
+   /// threads accumulate theirs without locking, and flush them only when    
+   /// they take the slow path, or exit. Until then, their allocations and    
+   /// deallocations in claimed pools are missing from the result             
+   ///   @return a copy of the statistics, taken under lock                   
+   auto Allocator::GetStatistics() noexcept -> Statistics {
+      const ::std::scoped_lock lock {Instance.mMutex};
+      Instance.FlushStatistics(LocalCache);
       return Instance.mStatistics;
    }
 
+   /// Account for new entries of a Region, in the counters of the calling    
+   /// thread, just like entries in pools claimed by it                       
+   ///   @param count - the number of entries                                 
+   ///   @param bytes - the bytes of all entries, including their overhead    
+   void Allocator::AddEntries(Count count, Offset bytes) noexcept {
+      LocalCache.mEntries += count;
+      LocalCache.mBytesAllocatedByFrontend += bytes;
+   }
+
+   /// Account for entries of a Region, that were forgotten all at once       
+   ///   @param count - the number of entries                                 
+   ///   @param bytes - the bytes of all entries, including their overhead    
+   void Allocator::DelEntries(Count count, Offset bytes) noexcept {
+      LocalCache.mEntries -= count;
+      LocalCache.mBytesAllocatedByFrontend -= bytes;
+   }
+
    /// Dump a single pool                                                     
    ///   @param id - pool id                                                  
    ///   @param pool - the pool to dump                                       
@@ -743,6 +2004,25 @@ namespace Langulus::Fractalloc
          fmt::format("{:x}", reinterpret_cast<Pointer>(pool)), Logger::Pop
       );
 
+      if (pool->mMeta) {
+         Logger::Line("Associated type: `",
+            pool->mMeta->mCppName, "`, of size ", pool->mMeta->mSize);
+      }
+
+      // Pools claimed by other threads change without locking, so only 
+      // what they publish atomically is reported                       
+      const auto owner = pool->mOwner.load(::std::memory_order_relaxed);
+      if (owner and owner != &LocalCache) {
+         const auto entries = Pool::Load(pool->mEntries);
+         Count used = 0;
+         for (Offset word = 0; word * Pool::BitsPerWord < entries; ++word)
+            used += ::std::popcount(Pool::Load(pool->mOccupancy[word], ::std::memory_order_acquire));
+
+         Logger::Line("Claimed by another thread, with ",
+            Logger::PushGreen, used, Logger::Pop, " of ", entries, " entries in use");
+         return;
+      }
+
       Logger::Line("In use/reserved: ", 
          Logger::PushGreen, Size {pool->mAllocatedByFrontend}, Logger::Pop,
          '/',
@@ -757,73 +2037,63 @@ namespace Langulus::Fractalloc
          Logger::PushRed, Size {pool->mAllocatedByBackend}, Logger::Pop
       );
 
-      if (pool->mMeta) {
-         Logger::Line("Associated type: `",
-            pool->mMeta->mCppName, "`, of size ", pool->mMeta->mSize);
-      }
-
       if (pool->mEntries) {
          const auto escope = Logger::Section("Active entries: ",
             Logger::PushGreen, pool->mEntries, Logger::Pop
          );
 
-         Count consecutiveEmpties = 0;
-         Count ecounter = 0;
-         do {
-            const auto entry = pool->AllocationFromIndex(ecounter);
-            if (entry->mReferences) {
-               if (consecutiveEmpties) {
-                  if (consecutiveEmpties == 1)
-                     Logger::Line(Logger::Red, ecounter-1, "] ", "unused entry");
-                  else
-                     Logger::Line(Logger::Red, ecounter - consecutiveEmpties, '-', ecounter-1, "] ",
-                        consecutiveEmpties, " unused entries");
-                  consecutiveEmpties = 0;
-               }
-
-               Logger::Line(
-                  Logger::Green, ecounter, "] ", Logger::Hex(entry), " ",
-                  Size {entry->mAllocatedBytes}, ", ",
-                  entry->mReferences, " references: `"
-               );
+         // Log a range of unused entries [from, to)                    
+         const auto dumpUnused = [](Offset from, Offset to) {
+            if (to - from == 1)
+               Logger::Line(Logger::Red, from, "] ", "unused entry");
+            else if (to > from)
+               Logger::Line(Logger::Red, from, '-', to - 1, "] ",
+                  to - from, " unused entries");
+         };
+
+         // Only used entries are visited, thanks to the occupancy      
+         // bitmap - the unused ones in between are just counted        
+         Offset next = 0;
+         for (auto ecounter = pool->NextOccupied(0); ecounter != Pool::InvalidIndex;
+                   ecounter = pool->NextOccupied(ecounter + 1)) {
+            dumpUnused(next, ecounter);
+            next = ecounter + 1;
 
-               auto raw = entry->GetBlockStart();
-               for (Offset i = 0; i < ::std::min(Offset {16}, entry->mAllocatedBytes); ++i) {
-                  if (::isprint(raw[i].mValue))
-                     Logger::Append(static_cast<char>(raw[i].mValue));
-                  else
-                     Logger::Append('?');
-               }
+            const auto entry = pool->AllocationFromIndex(ecounter);
+            Logger::Line(
+               Logger::Green, ecounter, "] ", Logger::Hex(entry), " ",
+               Size {entry->GetAllocatedSize()}, ", ",
+               entry->mReferences, " references: `"
+            );
 
-               if (entry->mAllocatedBytes > 16)
-                  Logger::Append("...`");
+            auto raw = entry->GetBlockStart();
+            for (Offset i = 0; i < ::std::min(Offset {16}, entry->GetAllocatedSize()); ++i) {
+               if (::isprint(raw[i].mValue))
+                  Logger::Append(static_cast<char>(raw[i].mValue));
                else
-                  Logger::Append('`');
+                  Logger::Append('?');
             }
-            else ++consecutiveEmpties;
-         }
-         while (++ecounter < pool->mEntries);
 
-         if (consecutiveEmpties) {
-            if (consecutiveEmpties == 1)
-               Logger::Line(Logger::Red, ecounter-1, "] ", "unused entry");
+            if (entry->GetAllocatedSize() > 16)
+               Logger::Append("...`");
             else
-               Logger::Line(Logger::Red, ecounter - consecutiveEmpties, '-', ecounter-1, "] ",
-                  consecutiveEmpties, " unused entries");
-            consecutiveEmpties = 0;
+               Logger::Append('`');
          }
+
+         dumpUnused(next, pool->mEntries);
       }
    }
 
    /// Dump all currently allocated pools and entries, useful to locate leaks 
    void Allocator::DumpPools() noexcept {
+      const ::std::scoped_lock lock {Instance.mMutex};
       auto section = Logger::InfoTab("MANAGED MEMORY POOL DUMP");
 
       // Dump default pool chain                                        
-      if (Instance.mMainPoolChain) {
+      if (Instance.mMainPoolChain.mPools) {
          const auto scope = Logger::InfoTab(Logger::Purple, "MAIN POOL CHAIN: ");
          Count counter = 0;
-         auto pool = Instance.mMainPoolChain;
+         auto pool = Instance.mMainPoolChain.mPools;
          while (pool) {
             DumpPool(counter, pool);
             pool = pool->mNext;
@@ -833,16 +2103,35 @@ namespace Langulus::Fractalloc
 
       // Dump every size pool chain                                     
       for (Offset size = 0; size < sizeof(Offset) * 8; ++size) {
-         if (not Instance.mSizePoolChain[size])
+         if (not Instance.mSizePoolChain[size].mPools)
             continue;
 
-         const auto scope = Logger::InfoTab(Logger::Purple, 
+         const auto scope = Logger::InfoTab(Logger::Purple,
             "SIZE POOL CHAIN FOR ", Logger::Red, Size {1 << size},
             Logger::Purple, ": "
          );
 
          Count counter = 0;
-         auto pool = Instance.mSizePoolChain[size];
+         auto pool = Instance.mSizePoolChain[size].mPools;
+         while (pool) {
+            DumpPool(counter, pool);
+            pool = pool->mNext;
+            ++counter;
+         }
+      }
+
+      // Dump every aligned pool chain                                  
+      for (Offset align = 0; align < AlignmentBuckets; ++align) {
+         if (not Instance.mAlignedPoolChain[align].mPools)
+            continue;
+
+         const auto scope = Logger::InfoTab(Logger::Purple,
+            "ALIGNED POOL CHAIN FOR ", Logger::Red, Size {Offset {1} << align},
+            Logger::Purple, ": "
+         );
+
+         Count counter = 0;
+         auto pool = Instance.mAlignedPoolChain[align].mPools;
          while (pool) {
             DumpPool(counter, pool);
             pool = pool->mNext;
@@ -852,7 +2141,7 @@ namespace Langulus::Fractalloc
       
       // Dump every type pool chain                                     
       for (auto type : Instance.mInstantiatedTypes) {
-         auto pool = type->GetPool<Pool>();
+         auto pool = type->GetPool<Chain>()->mPools;
          if (not pool)
             continue;
 
@@ -876,10 +2165,25 @@ namespace Langulus::Fractalloc
             ++counter;
          }
       }
+
+      // Dump every large block                                         
+      const ::std::shared_lock largeLock {Instance.mLargeMutex};
+      if (not Instance.mLargeBlocks.empty()) {
+         const auto scope = Logger::InfoTab(Logger::Purple, "LARGE BLOCKS: ");
+         for (auto block : Instance.mLargeBlocks) {
+            const auto entry = block->GetAllocation();
+            Logger::Line(
+               Logger::Green, Logger::Hex(entry), " ",
+               Size {entry->GetAllocatedSize()}, " in ", Size {block->mMapped},
+               " of pages, ", entry->mReferences, " references"
+            );
+         }
+      }
    }
 
    /// Compare two statistics snapshots, and find the difference              
    void Allocator::Diff(const Statistics& with) noexcept {
+      const ::std::scoped_lock lock {Instance.mMutex};
       auto section = Logger::InfoTab("MANAGED MEMORY DIFF");
       auto& stats = Instance.mStatistics;
 
@@ -912,9 +2216,9 @@ namespace Langulus::Fractalloc
          );
 
          // Diff default pool chain                                     
-         if (Instance.mMainPoolChain) {
+         if (Instance.mMainPoolChain.mPools) {
             Count counter = 0;
-            auto pool = Instance.mMainPoolChain;
+            auto pool = Instance.mMainPoolChain.mPools;
             while (pool) {
                if (pool->mStep > with.mStep) {
                   Logger::Info(Logger::Purple, "Default pool: ");
@@ -927,11 +2231,11 @@ namespace Langulus::Fractalloc
 
          // Dump every size pool chain                                  
          for (Offset size = 0; size < sizeof(Offset) * 8; ++size) {
-            if (not Instance.mSizePoolChain[size])
+            if (not Instance.mSizePoolChain[size].mPools)
                continue;
 
             Count counter = 0;
-            auto pool = Instance.mSizePoolChain[size];
+            auto pool = Instance.mSizePoolChain[size].mPools;
             while (pool) {
                if (pool->mStep > with.mStep) {
                   Logger::Info(Logger::Purple, "Size ", Size {1 << size}, " pool: ");
@@ -942,9 +2246,23 @@ namespace Langulus::Fractalloc
             }
          }
 
+         // Dump every aligned pool chain                               
+         for (Offset align = 0; align < AlignmentBuckets; ++align) {
+            Count counter = 0;
+            auto pool = Instance.mAlignedPoolChain[align].mPools;
+            while (pool) {
+               if (pool->mStep > with.mStep) {
+                  Logger::Info(Logger::Purple, "Aligned ", Size {Offset {1} << align}, " pool: ");
+                  DumpPool(counter, pool);
+               }
+               pool = pool->mNext;
+               ++counter;
+            }
+         }
+
          // Dump every type pool chain                                  
          for (auto type : Instance.mInstantiatedTypes) {
-            auto pool = type->GetPool<Pool>();
+            auto pool = type->GetPool<Chain>()->mPools;
             if (not pool)
                continue;
 
@@ -986,11 +2304,15 @@ namespace Langulus::Fractalloc
    #endif
    }
 
-   /// Account for a newly allocated pool                                     
+   /// Account for a newly allocated pool, and stamp it with the current step 
+   ///   @attention must be called under lock                                 
    ///   @param pool - the pool to account for                                
-   void Allocator::Statistics::AddPool(const Pool* pool) noexcept {
+   void Allocator::Statistics::AddPool(Pool* pool) noexcept {
+      pool->mStep = mStep;
       mBytesAllocatedByBackend += pool->GetTotalSize();
       mBytesAllocatedByFrontend += pool->GetAllocatedByFrontend();
+      mHugePagePools += pool->mHugePages;
+      mCommitTime += pool->mCommitTime;
       ++mPools;
       ++mEntries;
    }
@@ -999,37 +2321,60 @@ namespace Langulus::Fractalloc
    ///   @param pool - the pool to account for                                
    void Allocator::Statistics::DelPool(const Pool* pool) noexcept {
       mBytesAllocatedByBackend -= pool->GetTotalSize();
+      mHugePagePools -= pool->mHugePages;
       --mPools;
    }
    
    /// Integrity check a pool chain                                           
-   ///   @param pool - [in/out] the start of the chain                        
+   ///   @param chain - the chain                                             
    ///   @return true if all checks passed                                    
-   bool Allocator::IntegrityCheckChain(const Pool* pool) {
-      while (pool) {
+   bool Allocator::IntegrityCheckChain(const Chain& chain) {
+      for (auto pool = chain.mPools; pool; pool = pool->mNext) {
+         const auto owner = pool->mOwner.load(::std::memory_order_relaxed);
+         if (pool->mGroup != Pool::InvalidIndex and owner) {
+            Logger::Error("Fractalloc: Pool ", Logger::Hex(pool),
+               " is claimed, but is still offered to other threads");
+            return false;
+         }
+
+         // Pools claimed by other threads change without locking, so   
+         // their entries can't be checked from here                    
+         if (owner and owner != &LocalCache)
+            continue;
+
          if (pool->IsInUse()) {
             Count validAllocations = 0;
             Count validBytes = 0;
-            for (Count i = 0; i < pool->mEntries; ++i) {
+            bool failure = false;
+
+            // Only used entries are visited, thanks to the occupancy   
+            // bitmap                                                   
+            for (auto i = pool->NextOccupied(0); i != Pool::InvalidIndex;
+                      i = pool->NextOccupied(i + 1)) {
                auto allocation = pool->AllocationFromIndex(i);
-               if (allocation->mReferences) {
-                  if (allocation->mReferences > 100000) {
-                     Logger::Warning(
-                        "Fractalloc: Suspicious reference count in allocation ",
-                        Logger::Hex(allocation), " of size ", allocation->GetAllocatedSize(),
-                        " in pool ", Logger::Hex(pool), ", entry #", i, " of ", pool->mEntries
-                     );
-                  }
-
-                  ++validAllocations;
-                  validBytes += allocation->GetTotalSize();
+               if (not allocation->mReferences) {
+                  Logger::Error(
+                     "Fractalloc: Allocation ", Logger::Hex(allocation),
+                     " is marked as used, but has no references, in pool ",
+                     Logger::Hex(pool), ", entry #", i, " of ", pool->mEntries
+                  );
+                  failure = true;
+               }
+               else if (allocation->mReferences > 100000) {
+                  Logger::Warning(
+                     "Fractalloc: Suspicious reference count in allocation ",
+                     Logger::Hex(allocation), " of size ", allocation->GetAllocatedSize(),
+                     " in pool ", Logger::Hex(pool), ", entry #", i, " of ", pool->mEntries
+                  );
                }
+
+               ++validAllocations;
+               validBytes += pool->GetEntrySize(allocation);
             }
 
             //TODO also check if negative memory space contains a predefined pattern,
             // in order to detect writing outside boundaries
 
-            bool failure = false;
             if (validAllocations != pool->mValidEntries) {
                Logger::Error("Fractalloc: Valid entry mismatch: found ",
                   validAllocations, " entries, but ",
@@ -1051,8 +2396,6 @@ namespace Langulus::Fractalloc
             if (failure)
                return false;
          }
-
-         pool = pool->mNext;
       }
 
       return true;
@@ -1060,8 +2403,10 @@ namespace Langulus::Fractalloc
    
    /// Integrity checks                                                       
    bool Allocator::IntegrityCheck() {
+      const ::std::scoped_lock lock {Instance.mMutex};
+
       // Integrity check the default chain                              
-      if (Instance.mMainPoolChain) {
+      if (Instance.mMainPoolChain.mPools) {
          VERBOSE("Integrity check: mMainPoolChain...");
          if (not Instance.IntegrityCheckChain(Instance.mMainPoolChain))
             return false;
@@ -1070,23 +2415,44 @@ namespace Langulus::Fractalloc
       // Integrity check all size chains                                
       UNUSED() int size = 1;
       for (auto& sizeChain : Instance.mSizePoolChain) {
-         if (sizeChain) {
+         if (sizeChain.mPools) {
             VERBOSE("Integrity check: mSizePoolChain #", size++, "...");
             if (not Instance.IntegrityCheckChain(sizeChain))
                return false;
          }
       }
+
+      // Integrity check all aligned chains                             
+      for (auto& alignedChain : Instance.mAlignedPoolChain) {
+         if (alignedChain.mPools) {
+            VERBOSE("Integrity check: aligned chain for ", Size {alignedChain.mAlignment}, "...");
+            if (not Instance.IntegrityCheckChain(alignedChain))
+               return false;
+         }
+      }
       
       // Integrity check all type chains                                
       for (auto& typeChain : Instance.mInstantiatedTypes) {
-         auto& relevantPool = typeChain->GetPool<Pool>();
-         if (relevantPool) {
+         const auto relevantChain = typeChain->GetPool<Chain>();
+         if (relevantChain->mPools) {
             VERBOSE("Integrity check for type ", typeChain->mToken, "...");
-            if (not Instance.IntegrityCheckChain(relevantPool))
+            if (not Instance.IntegrityCheckChain(*relevantChain))
                return false;
          }
       }
 
+      // Integrity check all large blocks                               
+      const ::std::shared_lock largeLock {Instance.mLargeMutex};
+      for (auto block : Instance.mLargeBlocks) {
+         const auto entry = block->GetAllocation();
+         if (entry->GetPool() or not entry->mReferences
+         or entry->mAllocatedBytes > block->GetCapacity()) {
+            Logger::Error("Fractalloc: Large block ", Logger::Hex(block),
+               " has an invalid entry");
+            return false;
+         }
+      }
+
       return true;
    }
 #endif
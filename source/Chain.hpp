@@ -0,0 +1,205 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Pool.hpp"
+#include <bit>
+
+
+namespace Langulus::Fractalloc
+{
+
+   ///                                                                        
+   ///   Pool chain                                                           
+   ///                                                                        
+   /// Holds all pools of a chain, and additionally groups the unclaimed      
+   /// ones by the biggest entry they can currently accept. A pool, that      
+   /// can satisfy a request, is then found with a single bit scan, instead   
+   /// of walking the chain and trying every pool in it. Pools move between   
+   /// groups as they fill up and drain. Full pools and pools claimed by      
+   /// a thread cache aren't in any group                                     
+   /// The chain also picks the size of its next pool from demand - it        
+   /// grows geometrically, while new pools are made without any being        
+   /// released in between, and shrinks back with each released pool          
+   /// Chains of small, same-sized elements keep their pools as slabs, see    
+   /// Pool::MakeSlab, and chains of over-aligned requests keep them aligned, 
+   /// see Pool::MakeAligned                                                  
+   /// Slab slots are headerless - they are exactly the power-of-two element  
+   /// size, while the headers of their entries are kept aside                
+   ///                                                                        
+   struct Chain {
+      // Biggest pool a chain grows to, relative to its smallest pool   
+      static constexpr Offset MaxGrowth = 16;
+      // Smallest number of allocation pages, that a pool of a type     
+      // chain holds, see RTTI::MetaData::mAllocationPage               
+      static constexpr Offset MinPages = 64;
+      // Smallest number of entries in a slab - elements too big for    
+      // that are pooled fractally instead                              
+      static constexpr Count MinSlots = 64;
+
+      // All pools in the chain, doubly-linked through Pool::mNext and  
+      // Pool::mPrev                                                    
+      Pool* mPools {};
+      // Unclaimed pools that can accept new entries, grouped by the    
+      // log2 of their current threshold, and doubly-linked through     
+      // Pool::mGroupNext and Pool::mGroupPrev                          
+      Pool* mGroups[Pool::Levels] {};
+      // A bit for each group that has any pools in it                  
+      Offset mGroupLevels {};
+      // Size of the next pool, and the limits it adapts within         
+      Offset mPoolSize = Pool::DefaultPoolSize;
+      Offset mPoolSizeMin = Pool::DefaultPoolSize;
+      Offset mPoolSizeMax = ::std::min(Pool::DefaultPoolSize * MaxGrowth, Pool::MaxPoolSize);
+      // Whether a pool was released since the last one was made        
+      bool mReleased {};
+      // Size of every entry in the chain's pools, if they're slabs     
+      Offset mSlot {};
+      // Alignment of every entry in the chain's pools, if it's bigger  
+      // than Alignment, or zero                                        
+      Offset mAlignment {};
+
+      NOD() static constexpr Offset SlabSize(Offset) noexcept;
+      NOD() Offset Grow() noexcept;
+      void Shrink() noexcept;
+      void Link(Pool*) noexcept;
+      void Unlink(Pool*) noexcept;
+      void Sort(Pool*) noexcept;
+      void Detach(Pool*) noexcept;
+      NOD() Pool* Fetch(Offset) const noexcept;
+   };
+
+
+   /// Get the size of the slab entries for elements up to a power-of-two     
+   ///   @param log2 - the log2 of the biggest element size                   
+   ///   @return the entry size, including the Allocation overhead, or zero   
+   ///      if the elements are too big for slabs - the overhead is zero      
+   ///      only with LANGULUS_FRACTALLOC(DETACHED_HEADERS)                   
+   LANGULUS(INLINED)
+   constexpr Offset Chain::SlabSize(Offset log2) noexcept {
+      if (log2 >= Pool::Levels - 1)
+         return 0;
+
+      const auto slot = Allocation::GetNewAllocationSize(Offset {1} << log2);
+      return slot <= Pool::DefaultPoolSize / MinSlots ? slot : 0;
+   }
+
+   /// Get the size for a new pool, and adapt the size of the next one        
+   /// The next pool is twice as big, unless a pool was released since the    
+   /// last one was made                                                      
+   ///   @return the size of the usable memory for the new pool               
+   LANGULUS(INLINED)
+   Offset Chain::Grow() noexcept {
+      const auto size = mPoolSize;
+      if (mReleased)
+         mReleased = false;
+      else
+         mPoolSize = ::std::min(mPoolSize * 2, mPoolSizeMax);
+      return size;
+   }
+
+   /// Make the next pool smaller, after a pool of the chain was released     
+   LANGULUS(INLINED)
+   void Chain::Shrink() noexcept {
+      mPoolSize = ::std::max(mPoolSize / 2, mPoolSizeMin);
+      mReleased = true;
+   }
+
+   /// Add a new pool at the front of the chain                               
+   /// The pool isn't sorted into any group yet                               
+   ///   @param pool - the pool to add                                        
+   LANGULUS(INLINED)
+   void Chain::Link(Pool* pool) noexcept {
+      pool->mNext = mPools;
+      pool->mPrev = nullptr;
+      if (mPools)
+         mPools->mPrev = pool;
+      pool->mChain = this;
+      mPools = pool;
+   }
+
+   /// Remove a pool from the chain                                           
+   ///   @attention assumes pool is in this chain, and isn't in any group     
+   ///   @param pool - the pool to remove                                     
+   LANGULUS(INLINED)
+   void Chain::Unlink(Pool* pool) noexcept {
+      if (pool->mPrev)
+         pool->mPrev->mNext = pool->mNext;
+      else
+         mPools = pool->mNext;
+
+      if (pool->mNext)
+         pool->mNext->mPrev = pool->mPrev;
+
+      pool->mNext = pool->mPrev = nullptr;
+      pool->mChain = nullptr;
+   }
+
+   /// Remove a pool from the group it's in, if any                           
+   ///   @param pool - the pool to remove                                     
+   LANGULUS(INLINED)
+   void Chain::Detach(Pool* pool) noexcept {
+      if (pool->mGroup == Pool::InvalidIndex)
+         return;
+
+      if (pool->mGroupPrev)
+         pool->mGroupPrev->mGroupNext = pool->mGroupNext;
+      else {
+         mGroups[pool->mGroup] = pool->mGroupNext;
+         if (not pool->mGroupNext)
+            mGroupLevels &= ~(Offset {1} << pool->mGroup);
+      }
+
+      if (pool->mGroupNext)
+         pool->mGroupNext->mGroupPrev = pool->mGroupPrev;
+
+      pool->mGroup = Pool::InvalidIndex;
+      pool->mGroupNext = pool->mGroupPrev = nullptr;
+   }
+
+   /// Move a pool to the group, that matches its current state               
+   /// Thresholds are rounded up to a power-of-two, which matters only for    
+   /// slabs - they are never asked for more than their slot size             
+   ///   @attention assumes pool is in this chain, and isn't claimed          
+   ///   @param pool - the pool to sort                                       
+   LANGULUS(INLINED)
+   void Chain::Sort(Pool* pool) noexcept {
+      const auto group = pool->CanContain(pool->mThresholdMin)
+         ? Offset(::std::bit_width(pool->mThreshold - 1))
+         : Pool::InvalidIndex;
+      if (group == pool->mGroup)
+         return;
+
+      Detach(pool);
+      if (group == Pool::InvalidIndex)
+         return;
+
+      // Push to the front of the new group                             
+      const auto bit = Offset {1} << group;
+      pool->mGroupNext = (mGroupLevels & bit) ? mGroups[group] : nullptr;
+      if (pool->mGroupNext)
+         pool->mGroupNext->mGroupPrev = pool;
+      mGroups[group] = pool;
+      mGroupLevels |= bit;
+      pool->mGroup = group;
+   }
+
+   /// Find an unclaimed pool, that can accept an entry                       
+   /// The pool with the smallest sufficient threshold is picked, so that     
+   /// pools with more space remain available for bigger entries              
+   ///   @param bytes - the entry size, including the Allocation overhead     
+   ///   @return the pool, or nullptr if no pool in the chain can accept it   
+   LANGULUS(INLINED)
+   Pool* Chain::Fetch(Offset bytes) const noexcept {
+      const auto smallest = Offset(::std::bit_width(bytes - 1));
+      if (smallest >= Pool::Levels)
+         return nullptr;
+
+      const auto fitting = mGroupLevels & ~((Offset {1} << smallest) - 1);
+      return fitting ? mGroups[::std::countr_zero(fitting)] : nullptr;
+   }
+
+} // namespace Langulus::Fractalloc
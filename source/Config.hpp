@@ -17,3 +17,62 @@
 
 /// Make the rest of the code aware, that Langulus::Fractalloc is included    
 #define LANGULUS_LIBRARY_FRACTALLOC() 1
+
+#define LANGULUS_FRACTALLOC(a) LANGULUS_FRACTALLOC_##a()
+
+/// Place the usable memory of each pool on a boundary of DefaultPoolSize,    
+/// so that a granule of the pool directory always belongs to exactly one     
+/// pool. Costs some reserved, but never touched, address space per pool      
+#ifdef LANGULUS_ENABLE_FRACTALLOC_ALIGNED_POOLS
+   #define LANGULUS_FRACTALLOC_ALIGNED_POOLS() 1
+#else
+   #define LANGULUS_FRACTALLOC_ALIGNED_POOLS() 0
+#endif
+
+/// Place the usable memory of each pool on a huge page boundary, and ask     
+/// the OS to back it with transparent huge pages, so that accesses spread    
+/// across a pool don't miss the TLB every 4 KB                               
+#ifdef LANGULUS_ENABLE_FRACTALLOC_HUGE_PAGES
+   #define LANGULUS_FRACTALLOC_HUGE_PAGES() 1
+#else
+   #define LANGULUS_FRACTALLOC_HUGE_PAGES() 0
+#endif
+
+/// Use a compact 12-byte Allocation header (16 bytes with alignment          
+/// padding), with a 32-bit size and reference count, and a pool reference    
+/// relative to the entry, instead of a pointer. Small entries take much      
+/// less space, but no entry can be bigger than 4 GB, and no pool bigger      
+/// than 16 GB, see Pool::MaxPoolSize                                         
+#ifdef LANGULUS_ENABLE_FRACTALLOC_COMPACT_HEADERS
+   #define LANGULUS_FRACTALLOC_COMPACT_HEADERS() 1
+#else
+   #define LANGULUS_FRACTALLOC_COMPACT_HEADERS() 0
+#endif
+
+/// Keep the Allocation headers of pooled entries in a dense array after      
+/// the pool's usable memory, indexed like the entries, instead of right      
+/// in front of their client memory. Walking the entries of a pool streams    
+/// through the array, client memory stays free of headers, and overruns      
+/// can't corrupt them, but the array reserves address space for as many      
+/// entries as the pool could ever have. Can't be combined with compact       
+/// headers                                                                   
+#ifdef LANGULUS_ENABLE_FRACTALLOC_DETACHED_HEADERS
+   #define LANGULUS_FRACTALLOC_DETACHED_HEADERS() 1
+#else
+   #define LANGULUS_FRACTALLOC_DETACHED_HEADERS() 0
+#endif
+
+#if LANGULUS_FRACTALLOC_COMPACT_HEADERS() and LANGULUS_FRACTALLOC_DETACHED_HEADERS()
+   #error Compact and detached allocation headers cannot be combined
+#endif
+
+/// Size of the usable memory of a default pool, in bytes. Must be a          
+/// power-of-two. It is 1 MB, unless huge pages are enabled, in which case    
+/// it is a single 2 MB huge page                                             
+#if defined(LANGULUS_CUSTOM_FRACTALLOC_POOL_SIZE)
+   #define LANGULUS_FRACTALLOC_POOL_SIZE() (LANGULUS_CUSTOM_FRACTALLOC_POOL_SIZE)
+#elif LANGULUS_FRACTALLOC_HUGE_PAGES()
+   #define LANGULUS_FRACTALLOC_POOL_SIZE() (2 * 1024 * 1024)
+#else
+   #define LANGULUS_FRACTALLOC_POOL_SIZE() (1024 * 1024)
+#endif
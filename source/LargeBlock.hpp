@@ -0,0 +1,115 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Pool.hpp"
+#include "VirtualMemory.hpp"
+
+
+namespace Langulus::Fractalloc
+{
+
+   ///                                                                        
+   ///   Large block                                                          
+   ///                                                                        
+   /// Requests, that don't fit in a default pool, are mapped directly from   
+   /// the OS, and are given back as soon as they're deallocated. Pools for   
+   /// such requests would be rounded up to a power-of-two, and would make    
+   /// pool chains longer, while a large block costs just its pages           
+   /// The layout is: [LargeBlock::GetSize()][Allocation][client memory]      
+   /// Requests aligned beyond Alignment are preceded by as much padding as   
+   /// the alignment needs, that is never touched                             
+   /// The Allocation::mPool of the entry inside is always nullptr, which     
+   /// is how large entries are told apart from pooled ones                   
+   ///                                                                        
+   struct LargeBlock {
+      // Requests, whose Allocation::GetNewAllocationSize exceeds this, 
+      // are placed in a large block                                    
+      static constexpr Offset Threshold = Pool::DefaultPoolSize;
+
+      // Bytes mapped from the OS, a multiple of the page size          
+      Offset mMapped;
+      // Associated meta data                                           
+      DMeta mMeta;
+      // Start of the mapped pages, before any padding                  
+      void* mHandle;
+      // Alignment of the client memory, as requested                   
+      Offset mAlignment;
+
+      NOD() static constexpr Offset GetSize() noexcept;
+      NOD() static Offset GetNewAllocationSize(Offset, Offset) noexcept;
+
+      NOD() Allocation* GetAllocation() const noexcept;
+      NOD() Offset GetCapacity() const noexcept;
+      NOD() bool Contains(const void*) const noexcept;
+      NOD() const Allocation* Find(const void*) const noexcept;
+      NOD() static LargeBlock* From(const Allocation*) noexcept;
+   };
+
+
+   /// Get the size of the LargeBlock structure, rounded up for alignment     
+   ///   @return the byte size of the header, including alignment             
+   LANGULUS(INLINED)
+   constexpr Offset LargeBlock::GetSize() noexcept {
+      return sizeof(LargeBlock) + Alignment - (sizeof(LargeBlock) % Alignment);
+   }
+
+   /// Get the bytes to map for a new large block                             
+   ///   @param size - the usable number of bytes required                    
+   ///   @param alignment - the alignment of the client memory                
+   ///   @return the byte size, rounded up to whole pages                     
+   LANGULUS(INLINED)
+   Offset LargeBlock::GetNewAllocationSize(Offset size, Offset alignment) noexcept {
+      const auto padding = alignment > Alignment ? alignment - Alignment : 0;
+      return RoofToPage(GetSize() + Allocation::GetSize() + size + padding);
+   }
+
+   /// Get the entry inside the block                                         
+   ///   @return the entry                                                    
+   LANGULUS(INLINED)
+   Allocation* LargeBlock::GetAllocation() const noexcept {
+      return reinterpret_cast<Allocation*>(
+         const_cast<Byte*>(reinterpret_cast<const Byte*>(this) + GetSize()));
+   }
+
+   /// Get the biggest number of client bytes, that fit in the block          
+   ///   @return the capacity in bytes                                        
+   LANGULUS(INLINED)
+   Offset LargeBlock::GetCapacity() const noexcept {
+      return static_cast<const Byte*>(mHandle) + mMapped - GetAllocation()->GetBlockStart();
+   }
+
+   /// Check if an address is inside the mapped pages of the block            
+   ///   @param address - the address to check                                
+   ///   @return true if address is inside                                    
+   LANGULUS(INLINED)
+   bool LargeBlock::Contains(const void* address) const noexcept {
+      const auto a = reinterpret_cast<const Byte*>(address);
+      const auto start = reinterpret_cast<const Byte*>(this);
+      return a >= start and a < static_cast<const Byte*>(mHandle) + mMapped;
+   }
+
+   /// Find the memory entry from pointer                                     
+   ///   @param memory - memory pointer                                       
+   ///   @return the entry, if memory is inside its client memory             
+   LANGULUS(INLINED)
+   const Allocation* LargeBlock::Find(const void* memory) const noexcept {
+      const auto entry = GetAllocation();
+      return entry->Contains(memory) ? entry : nullptr;
+   }
+
+   /// Get the block that holds a large entry                                 
+   ///   @attention assumes entry is in a large block                         
+   ///   @param entry - the entry                                             
+   ///   @return the block                                                    
+   LANGULUS(INLINED)
+   LargeBlock* LargeBlock::From(const Allocation* entry) noexcept {
+      return reinterpret_cast<LargeBlock*>(
+         const_cast<Byte*>(reinterpret_cast<const Byte*>(entry) - GetSize()));
+   }
+
+} // namespace Langulus::Fractalloc
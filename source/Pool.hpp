@@ -7,18 +7,37 @@
 ///                                                                           
 #pragma once
 #include <Fractalloc/Allocator.hpp>
+#include "VirtualMemory.hpp"
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <span>
 
 
 namespace Langulus::Fractalloc
 {
 
    using RTTI::DMeta;
+   struct ThreadCache;
+   struct Chain;
 
    ///                                                                        
    ///   Memory pool                                                          
    ///                                                                        
+   /// Pools are modified only by their owner, or under Allocator lock, but   
+   /// any thread can search them with Find at any time. So mEntries,         
+   /// mThreshold and the occupancy bitmap are always written atomically,     
+   /// and an entry is marked occupied only after its header is complete      
+   ///                                                                        
    class Pool final {
    friend struct Allocator;
+   friend struct Chain;
+   friend class Region;
+   public:
+      static constexpr Offset CacheLine = 64;
+      // Number of fractal levels an index can be on                    
+      static constexpr Offset Levels = sizeof(Offset) * 8;
+
    protected:
       // Bytes allocated by the backend                                 
       const Offset mAllocatedByBackend {};
@@ -29,31 +48,97 @@ namespace Langulus::Fractalloc
       Offset mAllocatedByFrontend {};
       // Number of entries that have been used overall                  
       Count mEntries {};
-      // A chain of freed entries in the range [0-mEntries)             
-      Allocation* mLastFreed {};
+      // Chains of freed entries in the range [0-mEntries), one for each
+      // fractal level - level 0 is entry #0, and level L holds entries 
+      // in the range [2^(L-1), 2^L). Slabs keep all of them on level 0 
+      Allocation* mFreed[Levels] {};
+      // A bit for each level that has freed entries                    
+      Offset mFreedLevels {};
       // Current threshold, that is, max size of a new entry            
       Offset mThreshold {};
       Offset mThresholdPrevious {};
       // Smallest allocation possible for the pool                      
       Offset mThresholdMin {};
-      // Pointer to start of usable memory                              
+      // Size of every entry, including the Allocation overhead, if the 
+      // pool is a slab, or zero if entries are placed fractally. The   
+      // overhead is in mHeaders, so slots hold only client memory      
+      // See MakeSlab                                                   
+      Offset mSlot {};
+      // Alignment of the client memory of every entry, if bigger than  
+      // Alignment, or zero. See MakeAligned                            
+      Offset mAlignment {};
+      // Bytes between the start of an entry and its header, so that    
+      // the client memory after the header lands on mAlignment         
+      Offset mBias {};
+      // Next free byte, if the pool is filled like a stack by a Region,
+      // or nullptr if entries are placed fractally. See MakeBump       
+      Byte* mBump {};
+      // Number of used entries, whose total size rounds up to 2^N      
+      // Used to shrink mThresholdMin, when the biggest entries go away 
+      Count mSizes[Levels] {};
+      // A bit for each 2^N that has any used entries                   
+      Offset mSizeLevels {};
+      // Pointer to start of usable memory, and to the end of the       
+      // memory that entries are placed in - slabs keep their headers   
+      // after it, see MakeSlab                                         
       Byte* mMemory {};
       Byte* mMemoryEnd {};
+      // One bit per entry index, set while the entry is in use         
+      // Lives right after the usable memory, see GetOccupancySize()    
+      Offset* mOccupancy {};
+      // The headers of all entries, indexed like the entries, if they  
+      // are detached from the client memory. With                      
+      // LANGULUS_FRACTALLOC(DETACHED_HEADERS) they live right after    
+      // the occupancy bitmap, see GetHeadersSize(), otherwise only     
+      // slabs have them, at the end of the usable memory               
+      Allocation* mHeaders {};
       // Associated meta data, when types are reflected with nondefault 
-      // PoolTactic                                                     
+      // PoolTactic, so that the chain of the pool can be found again   
       DMeta mMeta {};
-      // Handle for the pool allocation, for use with ::std::free       
+      // Start of the pages mapped for the pool, for use with UnmapPages
       void* mHandle {};
+      // Whether the OS accepted to back the pool with huge pages       
+      bool mHugePages {};
 
-      // Next pool in the pool chain                                    
+      // Neighbours in the pool chain                                   
       Pool* mNext {};
+      Pool* mPrev {};
+      // The chain the pool is in, if any                               
+      Chain* mChain {};
+      // Neighbours in the chain group the pool is sorted in, if any    
+      // Groups are modified only under Allocator lock, see Chain       
+      Pool* mGroupNext {};
+      Pool* mGroupPrev {};
+      Offset mGroup = InvalidIndex;
+      // The garbage collection pass, that last visited the pool        
+      Count mCollectPass {};
+      // Neighbours in the list of pools, that became empty since they  
+      // were last collected, see Allocator::CollectEmptyPools          
+      Pool* mEmptyNext {};
+      Pool* mEmptyPrev {};
+      bool mEmptyListed {};
 
    #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-      // Acts like a timestamp of when the allocation happened          
-      Count mStep;
+      // Acts like a timestamp of when the pool was linked into a chain 
+      // Stamped under Allocator lock, see Statistics::AddPool          
+      Count mStep {};
       Count mValidEntries {};
+      // Time it took to commit the pool, see CommitPolicy              
+      ::std::chrono::nanoseconds mCommitTime {};
    #endif
 
+      // The thread cache that has claimed the pool. Only the owner can 
+      // modify a claimed pool without locking. Pools without an owner  
+      // are shared, and can be modified only under Allocator lock      
+      // Other threads touch only this cache line, so that they never   
+      // contend with the owner on the rest of the pool's state         
+      alignas(CacheLine) ::std::atomic<const ThreadCache*> mOwner {};
+      // Lock-free stack of entries, freed by threads that don't own    
+      // the pool. They remain in use, until the owner recycles them    
+      // While the pool isn't claimed, the stack is RemoteClosed, so    
+      // that entries can't be queued where no owner would recycle them 
+      ::std::atomic<Allocation*> mRemoteFreed {};
+
    public:
       Pool() = delete;
       Pool(const Pool&) = delete;
@@ -62,13 +147,40 @@ namespace Langulus::Fractalloc
 
       Pool(DMeta, Offset, void*) noexcept;
 
-      // Default pool allocation is 1 MB                                
-      static constexpr Offset DefaultPoolSize = 1024 * 1024;
+      // Default pool allocation, see LANGULUS_FRACTALLOC(POOL_SIZE)    
+      static constexpr Offset DefaultPoolSize = LANGULUS_FRACTALLOC(POOL_SIZE);
       static constexpr Offset InvalidIndex = ::std::numeric_limits<Offset>::max();
+      static constexpr Offset BitsPerWord = sizeof(Offset) * 8;
+      // Unused entries at least this big give their pages back to the  
+      // OS. Smaller ones are likely to be reused soon, and aren't worth
+      // the system call. With huge pages, anything smaller would just  
+      // split a huge page                                              
+      static constexpr Offset DecommitThreshold =
+         LANGULUS_FRACTALLOC(HUGE_PAGES) ? HugePageSize : 64 * 1024;
+
+      // Biggest usable memory of a pool. With                          
+      // LANGULUS_FRACTALLOC(COMPACT_HEADERS) entries reach their pool  
+      // through a 31-bit distance in multiples of Alignment, so pools  
+      // must be small enough for all their entries to be in reach      
+      static constexpr Offset MaxPoolSize =
+         LANGULUS_FRACTALLOC(COMPACT_HEADERS) and sizeof(Offset) > 4
+            ? Offset {1} << (30 + ::std::countr_zero(Alignment))
+            : Offset {1} << (Levels - 1);
+
+      static_assert(IsPowerOfTwo(DefaultPoolSize),
+         "Default pool size must be a power-of-two");
+      static_assert(DefaultPoolSize <= MaxPoolSize,
+         "Default pool size must not exceed the biggest pool size");
+      static_assert(not LANGULUS_FRACTALLOC(HUGE_PAGES) or DefaultPoolSize >= HugePageSize,
+         "Default pool size must be at least a huge page, when huge pages are enabled");
 
    public:
       NOD() static constexpr Offset GetSize() noexcept;
       NOD() static constexpr Offset GetNewAllocationSize(Offset) noexcept;
+      NOD() static constexpr Offset GetOccupancySize(Offset) noexcept;
+      NOD() static constexpr Offset GetHeadersSize(Offset) noexcept;
+      NOD() static constexpr Offset GetAlignedAllocationSize(Offset, Offset) noexcept;
+      NOD() static constexpr Offset GetBumpGranule() noexcept;
 
       template<class T = Allocation>
       NOD() T* GetPoolStart() noexcept;
@@ -82,12 +194,27 @@ namespace Langulus::Fractalloc
       NOD() constexpr Offset GetAllocatedByFrontend() const noexcept;
       NOD() constexpr bool IsInUse() const noexcept;
       NOD() constexpr bool CanContain(Offset) const noexcept;
+      NOD() constexpr bool IsSlab() const noexcept;
+      NOD() constexpr Offset GetEntrySize(Offset) const noexcept;
+      NOD() constexpr Offset GetEntrySize(const Allocation*) const noexcept;
       NOD() bool Contains(const void*) const noexcept;
       NOD() const Allocation* Find(const void*) const IF_UNSAFE(noexcept);
 
       NOD() Allocation* Allocate(Offset) IF_UNSAFE(noexcept);
+      NOD() Count AllocateBatch(Offset, ::std::span<Allocation*>) IF_UNSAFE(noexcept);
+      NOD() Allocation* Bump(Offset) IF_UNSAFE(noexcept);
       NOD() bool Reallocate(Allocation*, Offset) IF_UNSAFE(noexcept);
       void Deallocate(Allocation*) IF_UNSAFE(noexcept);
+      void Reset() noexcept;
+      NOD() bool PushRemote(Allocation*) noexcept;
+      NOD() bool PushRemote(::std::span<Allocation* const>) noexcept;
+      void DrainRemote() IF_UNSAFE(noexcept);
+      void OpenRemote() noexcept;
+      void CloseRemote() IF_UNSAFE(noexcept);
+      NOD() static Allocation* RemoteClosed() noexcept;
+      void MakeSlab(Offset) IF_UNSAFE(noexcept);
+      void MakeAligned(Offset) IF_UNSAFE(noexcept);
+      void MakeBump() IF_UNSAFE(noexcept);
       void FreePoolChain();
       void Null();
       void Touch();
@@ -95,10 +222,37 @@ namespace Langulus::Fractalloc
 
       NOD() Offset ThresholdFromIndex(Offset) const noexcept;
       NOD() const Allocation* AllocationFromIndex(Offset) const noexcept;
+      NOD() Byte* BlockFromIndex(Offset) const noexcept;
       NOD() Offset IndexFromAddress(const void*) const IF_UNSAFE(noexcept);
       NOD() Offset ValidateIndex(Offset) const noexcept;
       NOD() Offset UpIndex(Offset) const noexcept;
       NOD() const Allocation* AllocationFromAddress(const void*) const IF_UNSAFE(noexcept);
+      NOD() Offset IndexFromEntry(const Allocation*) const noexcept;
+      NOD() static Offset LevelFromIndex(Offset) noexcept;
+
+      NOD() bool IsOccupied(Offset) const noexcept;
+      NOD() Offset NextOccupied(Offset) const noexcept;
+      NOD() Offset NextVacant(Offset) const noexcept;
+      NOD() Offset PrevOccupied(Offset) const noexcept;
+      NOD() Offset LastOccupied() const noexcept;
+
+   protected:
+      NOD() Allocation* Carve(Offset) IF_UNSAFE(noexcept);
+      void Account(Offset, Count) IF_UNSAFE(noexcept);
+      void PushFreed(Allocation*, Offset) noexcept;
+      NOD() Allocation* PopFreed() noexcept;
+      void AddSize(Offset, Count = 1) noexcept;
+      void DelSize(Offset) noexcept;
+      void Occupy(Offset) IF_UNSAFE(noexcept);
+      void Vacate(Offset) noexcept;
+      void Vacate(Offset, Offset) noexcept;
+      void VacateAll() noexcept;
+      void Decommit(Offset, Offset) const noexcept;
+      void UpdateSlab() noexcept;
+      void RecycleRemote(Allocation*) IF_UNSAFE(noexcept);
+
+      NOD() static Offset Load(const Offset&, ::std::memory_order = ::std::memory_order_relaxed) noexcept;
+      static void Store(Offset&, Offset, ::std::memory_order = ::std::memory_order_relaxed) noexcept;
    };
 
 } // namespace Langulus::Fractalloc
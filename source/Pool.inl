@@ -10,17 +10,35 @@
 #include <Fractalloc/Allocator.hpp>
 #include <bit>
 
+#if defined(_MSC_VER) and (defined(_M_X64) or defined(_M_IX86))
+   #include <xmmintrin.h>
+#endif
+
 
 namespace Langulus::Fractalloc
 {
 
+   /// Hint the CPU to fetch the cache line of an address, that is about to   
+   /// be written. Never faults, even if the address isn't mapped             
+   ///   @param address - the address                                         
+   LANGULUS(INLINED)
+   void Prefetch(const void* address) noexcept {
+      #if defined(__GNUC__) or defined(__clang__)
+         __builtin_prefetch(address, 1);
+      #elif defined(_MSC_VER) and (defined(_M_X64) or defined(_M_IX86))
+         _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+      #else
+         (void) address;
+      #endif
+   }
+
    /// Initialize a pool                                                      
    ///   @attention relies that size is a power-of-two                        
    ///   @attention this constructor relies that instance is placed in the    
    ///      beginning of a heap allocation of size Pool::NewAllocationSize()  
    ///   @param meta - optional meta data associated with pool                
    ///   @param size - bytes of the usable block to initialize with           
-   ///   @param memory - handle for use with std::free()                      
+   ///   @param memory - start of the pages mapped for the pool               
    LANGULUS(INLINED)
    Pool::Pool(DMeta meta, Offset size, void* memory) noexcept
       : mAllocatedByBackend     {size}
@@ -36,19 +54,21 @@ namespace Langulus::Fractalloc
    {
       mMemory = GetPoolStart<Byte>();
       mMemoryEnd = mMemory + mAllocatedByBackend;
+      mOccupancy = reinterpret_cast<Offset*>(mMemoryEnd);
+      ZeroMemory(mOccupancy, GetOccupancySize(mAllocatedByBackend));
 
-      #if LANGULUS_FEATURE(MEMORY_STATISTICS)
-         mStep = Instance.GetStatistics().mStep;
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         mHeaders = reinterpret_cast<Allocation*>(
+            mMemoryEnd + GetOccupancySize(mAllocatedByBackend));
       #endif
 
-      // Touching is mandatory for pools - without touching the         
-      // memory, it might remain just a promise by the OS, making       
-      // initial pool allocations very, very, VERY slow                 
-      Touch();
+      // New pools aren't claimed                                       
+      mRemoteFreed.store(RemoteClosed(), ::std::memory_order_relaxed);
    }
 
    /// Get the minimum allocation for an entry inside this pool               
-   ///   @return the size in bytes, always a power-of-two                     
+   ///   @return the size in bytes, always a power-of-two, unless the pool    
+   ///      is a slab, in which case it is the size of every entry            
    LANGULUS(INLINED)
    constexpr Offset Pool::GetMinAllocation() const noexcept {
       return mThresholdMin;
@@ -58,7 +78,9 @@ namespace Langulus::Fractalloc
    ///   @return the size in bytes                                            
    LANGULUS(INLINED)
    constexpr Offset Pool::GetTotalSize() const noexcept {
-      return Pool::GetSize() + mAllocatedByBackend;
+      return Pool::GetSize() + mAllocatedByBackend
+         + GetOccupancySize(mAllocatedByBackend)
+         + GetHeadersSize(mAllocatedByBackend);
    }
 
    /// Get the max number of possible entries                                 
@@ -69,13 +91,111 @@ namespace Langulus::Fractalloc
       return mAllocatedByBackend / GetMinAllocation();
    }
 
+   /// Turn an empty pool into a slab, whose entries are all of the same      
+   /// size, and are placed one after another, instead of fractally. Slabs    
+   /// accept only entries up to that size, but pack them densely, in the     
+   /// order they're made, and find them with a single division               
+   /// Slots hold only client memory, so elements are contiguous, and each    
+   /// lands on its own power-of-two boundary. The headers are kept in an     
+   /// array at the end of the usable memory instead, indexed like the        
+   /// slots - the slab holds as many entries as before, since each one       
+   /// still costs the same overhead                                          
+   ///   @attention assumes the pool has never had any entries                
+   ///   @param slot - the size of every entry, including the Allocation      
+   ///      overhead, must be a multiple of Alignment, at least               
+   ///      Allocation::GetMinAllocation(), and not bigger than the pool      
+   LANGULUS(INLINED)
+   void Pool::MakeSlab(Offset slot) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, not mEntries,
+         "Only empty pools can become slabs");
+      LANGULUS_ASSUME(DevAssumes, slot % Alignment == 0
+         and slot >= Allocation::GetMinAllocation() and slot <= mAllocatedByBackend,
+         "Bad slab entry size");
+
+      mSlot = slot;
+      Store(mThreshold, slot);
+      mThresholdPrevious = mThresholdMin = slot;
+
+      #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         mMemoryEnd = mMemory + GetMaxEntries() * (slot - Allocation::GetOverhead());
+         mHeaders = reinterpret_cast<Allocation*>(mMemoryEnd);
+      #endif
+   }
+
+   /// Check if the pool is a slab                                            
+   ///   @return true if all entries in the pool are of the same size         
+   LANGULUS(INLINED)
+   constexpr bool Pool::IsSlab() const noexcept {
+      return mSlot != 0;
+   }
+
+   /// Make an empty pool align the client memory of all its entries to a     
+   /// power-of-two bigger than Alignment. Entries are padded to at least     
+   /// that size, so the fractal layout places each of them on a multiple     
+   /// of it, and their headers are shifted by the same bias inside each      
+   /// entry, so that the client memory after them lands on the boundary.     
+   /// If the pool memory is already aligned, the bias is zero                
+   ///   @attention assumes the pool has never had any entries, and isn't     
+   ///      a slab                                                            
+   ///   @param alignment - the alignment, a power-of-two bigger than         
+   ///      Alignment, and not bigger than the pool                           
+   LANGULUS(INLINED)
+   void Pool::MakeAligned(Offset alignment) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, not mEntries and not mSlot,
+         "Only empty fractal pools can be aligned");
+      LANGULUS_ASSUME(DevAssumes, IsPowerOfTwo(alignment)
+         and alignment > Alignment and alignment <= mAllocatedByBackend,
+         "Bad entry alignment");
+
+      const auto first = reinterpret_cast<Pointer>(mMemory) + Allocation::GetOverhead();
+      mAlignment = alignment;
+      mBias = (alignment - (first & (alignment - 1))) & (alignment - 1);
+   }
+
+   /// Make an empty pool fill like a stack, for a Region. Entries are        
+   /// bumped one after another, each rounded up to GetBumpGranule(), and     
+   /// found by a backward scan of the occupancy bitmap. Freed entries are    
+   /// only vacated - the space is reclaimed, if they were on top of the      
+   /// stack, or when the whole pool is Reset. The fractal threshold is       
+   /// closed, so that the pool never accepts entries through Allocate        
+   ///   @attention assumes the pool has never had any entries, and isn't     
+   ///      a slab, nor aligned                                               
+   LANGULUS(INLINED)
+   void Pool::MakeBump() IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, not mEntries and not mSlot and not mAlignment,
+         "Only empty fractal pools can be filled like a stack");
+
+      mBump = mMemory;
+      Store(mThreshold, 0);
+      mThresholdPrevious = 0;
+   }
+
+   /// Get the bytes a new entry takes in the pool                            
+   ///   @param bytes - the usable number of bytes required                   
+   ///   @return the byte size, including the Allocation overhead, and any    
+   ///      padding for alignment                                             
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetEntrySize(Offset bytes) const noexcept {
+      return ::std::max(mBias + Allocation::GetNewAllocationSize(bytes), mAlignment);
+   }
+
+   /// Get the bytes an entry takes in the pool                               
+   ///   @attention assumes entry is in this pool                             
+   ///   @param entry - the entry                                             
+   ///   @return the byte size, including the Allocation overhead, and any    
+   ///      padding for alignment                                             
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetEntrySize(const Allocation* entry) const noexcept {
+      return mBias + entry->GetTotalSize();
+   }
+
    /// Free the whole pool chain                                              
    ///   @attention make sure this is called for the first pool in the chain  
    LANGULUS(INLINED)
    void Pool::FreePoolChain() {
       if (mNext)
          mNext->FreePoolChain();
-      ::std::free(mHandle);
+      Allocator::DeallocatePool(this);
    }
 
    /// Get the size of the Pool structure, rounded up for alignment           
@@ -87,14 +207,69 @@ namespace Langulus::Fractalloc
 
    /// Get the size for a new pool allocation, with alignment/additional      
    /// memory requirements                                                    
+   /// The layout is:                                                         
+   ///   [Pool::GetSize()][usable memory][occupancy bitmap][headers]          
    ///   @assumes size is a power-of-two                                      
    ///   @assumes size can contain at least one Allocation::GetMinAllocation  
    ///   @param size - the number of bytes to request for the pool            
    ///   @return the number of bytes to allocate for use in the pool          
    LANGULUS(INLINED)
    constexpr Offset Pool::GetNewAllocationSize(Offset size) noexcept {
-      constexpr auto minimum = Pool::DefaultPoolSize + Pool::GetSize();
-      return ::std::max(size + Pool::GetSize(), minimum);
+      const auto usable = ::std::max(size, Pool::DefaultPoolSize);
+      return Pool::GetSize() + usable + GetOccupancySize(usable)
+         + GetHeadersSize(usable);
+   }
+
+   /// Get the size of the occupancy bitmap for a pool                        
+   /// There's a bit for each entry the pool can ever have - entries are      
+   /// never smaller than Allocation::GetMinAllocation, whether they're       
+   /// placed at power-of-two thresholds, or packed in a slab                 
+   ///   @param size - the number of usable bytes in the pool                 
+   ///   @return the size of the bitmap in bytes, always a multiple of Offset 
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetOccupancySize(Offset size) noexcept {
+      constexpr Offset smallest = Allocation::GetMinAllocation();
+      const Offset entries = ::std::max(size / smallest, Offset {1});
+      return ((entries + BitsPerWord - 1) / BitsPerWord) * sizeof(Offset);
+   }
+
+   /// Get the size of the array of entry headers for a pool                  
+   /// With LANGULUS_FRACTALLOC(DETACHED_HEADERS) there's a header for each   
+   /// entry the pool can ever have, just like in the occupancy bitmap        
+   ///   @param size - the number of usable bytes in the pool                 
+   ///   @return the size of the array in bytes, or zero if headers are in    
+   ///      front of the client memory of each entry                          
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetHeadersSize(Offset size) noexcept {
+      if constexpr (LANGULUS_FRACTALLOC(DETACHED_HEADERS)) {
+         constexpr Offset smallest = Allocation::GetMinAllocation();
+         return ::std::max(size / smallest, Offset {1}) * sizeof(Allocation);
+      }
+      else return 0;
+   }
+
+   /// Get the most bytes a new entry can take in a pool, whose entries are   
+   /// aligned beyond Alignment, see MakeAligned                              
+   ///   @param bytes - the usable number of bytes required                   
+   ///   @param alignment - the alignment of the client memory, a             
+   ///      power-of-two                                                      
+   ///   @return the byte size, including the Allocation overhead, and the    
+   ///      worst padding that the alignment might need                       
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetAlignedAllocationSize(Offset bytes, Offset alignment) noexcept {
+      const auto total = Allocation::GetNewAllocationSize(bytes);
+      if (alignment <= Alignment)
+         return total;
+      return ::std::max(total + alignment - Alignment, alignment);
+   }
+
+   /// Get the step, at which entries are bumped in a pool, that is filled    
+   /// like a stack - each granule has its own bit in the occupancy bitmap,   
+   /// and its own header with LANGULUS_FRACTALLOC(DETACHED_HEADERS)          
+   ///   @return the smallest power-of-two, that fits the smallest entry      
+   LANGULUS(INLINED)
+   constexpr Offset Pool::GetBumpGranule() noexcept {
+      return ::std::bit_ceil(Allocation::GetMinAllocation());
    }
 
    /// Get the start of the usable memory for the pool                        
@@ -132,45 +307,145 @@ namespace Langulus::Fractalloc
    ///   @param bytes - number of bytes to allocate                           
    ///   @return the new allocation, or nullptr if pool is full               
    inline Allocation* Pool::Allocate(const Offset bytes) IF_UNSAFE(noexcept) {
+      // Recycle entries freed by other threads, when we run out of     
+      // locally freed ones                                             
+      if (not mFreedLevels and mRemoteFreed.load(::std::memory_order_relaxed))
+         DrainRemote();
+
       // Check if we can add a new entry                                
-      const auto bytesWithPadding = Allocation::GetNewAllocationSize(bytes);
+      const auto bytesWithPadding = GetEntrySize(bytes);
       if (not CanContain(bytesWithPadding))
          return nullptr;
 
+      const auto newEntry = Carve(bytesWithPadding);
+      Account(bytesWithPadding, 1);
+      return newEntry;
+   }
+
+   /// Allocate many entries of the same size at once, until the pool is      
+   /// full. Entries are carved in a single pass, and accounted for all at    
+   /// once. The header of the entry, that comes next, is prefetched while    
+   /// the current one is made, so that the next pop from the freed lists     
+   /// doesn't stall on it                                                    
+   ///   @param bytes - number of bytes to allocate for each entry            
+   ///   @param result - [out] the new entries                                
+   ///   @return the number of entries made, fewer than requested if the      
+   ///      pool got full                                                     
+   inline Count Pool::AllocateBatch(const Offset bytes, ::std::span<Allocation*> result)
+   IF_UNSAFE(noexcept) {
+      if (not mFreedLevels and mRemoteFreed.load(::std::memory_order_relaxed))
+         DrainRemote();
+
+      const auto bytesWithPadding = GetEntrySize(bytes);
+      Count done = 0;
+      while (done < result.size() and CanContain(bytesWithPadding)) {
+         result[done++] = Carve(bytesWithPadding);
+         Prefetch(mFreedLevels
+            ? mFreed[::std::countr_zero(mFreedLevels)]
+            : AllocationFromIndex(mEntries));
+      }
+
+      if (done)
+         Account(bytesWithPadding, done);
+      return done;
+   }
+
+   /// Make a new entry, by recycling a freed one, or by adding one after     
+   /// the last. The entry isn't accounted for, see Account                   
+   ///   @attention assumes CanContain(bytes)                                 
+   ///   @param bytes - the entry size, as given by GetEntrySize              
+   ///   @return the new entry                                                
+   LANGULUS(INLINED)
+   Allocation* Pool::Carve(const Offset bytes) IF_UNSAFE(noexcept) {
       Allocation* newEntry;
-      if (mLastFreed) {
+      Offset index;
+      if (mFreedLevels) {
          // Recycle entries                                             
-         newEntry = mLastFreed;
-         mLastFreed = mLastFreed->mNextFreeEntry;
-         new (newEntry) Allocation {
-            bytesWithPadding - Allocation::GetSize(), this
-         };
+         newEntry = PopFreed();
+         index = IndexFromEntry(newEntry);
       }
       else {
          // The entire pool is full (or empty), skip search for free    
          // spot, add a new allocation directly	instead                 
-         newEntry = const_cast<Allocation*>(AllocationFromIndex(mEntries));
-         new (newEntry) Allocation {
-            bytesWithPadding - Allocation::GetSize(), this
-         };
-
-         ++mEntries;
+         index = mEntries;
+         Store(mEntries, index + 1);
+         newEntry = const_cast<Allocation*>(AllocationFromIndex(index));
 
-         if (reinterpret_cast<Byte*>(newEntry) + mThreshold >= mMemoryEnd) {
+         if (not mSlot and BlockFromIndex(index) + mThreshold >= mMemoryEnd) {
             // Reset carriage and shift level when it goes beyond       
             mThresholdPrevious = mThreshold;
-            mThreshold >>= Offset {1};
+            Store(mThreshold, mThreshold >> Offset {1});
          }
       }
 
-      // Always adapt min threshold if bigger entry is introduced       
-      if (bytesWithPadding > mThresholdMin)
-         mThresholdMin = Roof2(bytesWithPadding);
+      new (newEntry) Allocation {
+         bytes - mBias - Allocation::GetOverhead(), this
+      };
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         newEntry->mBlock = BlockFromIndex(index) + mBias;
+      #else
+         if (mSlot)
+            newEntry->Detach();
+      #endif
+      Occupy(index);
+
+      if (mSlot)
+         UpdateSlab();
+      return newEntry;
+   }
+
+   /// Account for new entries of the same size                               
+   ///   @param bytes - the size of each entry, as given by GetEntrySize      
+   ///   @param count - the number of new entries                             
+   LANGULUS(INLINED)
+   void Pool::Account(const Offset bytes, const Count count) IF_UNSAFE(noexcept) {
+      if (not mSlot) {
+         // Always adapt min threshold if bigger entry is introduced    
+         if (bytes > mThresholdMin)
+            mThresholdMin = Roof2(bytes);
+         AddSize(bytes, count);
+      }
 
       LANGULUS_ASSUME(DevAssumes,
-         mAllocatedByFrontend + bytesWithPadding >= mAllocatedByFrontend,
+         mAllocatedByFrontend + bytes * count >= mAllocatedByFrontend,
          "Frontend byte counter overflow");
-      mAllocatedByFrontend += bytesWithPadding;
+      mAllocatedByFrontend += bytes * count;
+      IF_LANGULUS_MEMORY_STATISTICS(mValidEntries += count);
+   }
+
+   /// Allocate an entry on top of a pool, that is filled like a stack        
+   /// Bits left over from before the last Reset are cleared on the way, so   
+   /// that the bitmap is exact below mEntries                                
+   ///   @attention assumes the pool was made with MakeBump                   
+   ///   @param bytes - number of bytes to allocate                           
+   ///   @return the new allocation, or nullptr if pool is full               
+   inline Allocation* Pool::Bump(const Offset bytes) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, mBump, "Pool isn't filled like a stack");
+
+      // Entries freed by other threads might free the top of the stack 
+      if (mRemoteFreed.load(::std::memory_order_relaxed))
+         DrainRemote();
+
+      constexpr Offset granule = GetBumpGranule();
+      const auto total = Allocation::GetNewAllocationSize(bytes);
+      const auto size = (total + granule - 1) & ~(granule - 1);
+      if (size > static_cast<Offset>(mMemoryEnd - mBump))
+         return nullptr;
+
+      const auto index = static_cast<Offset>(mBump - mMemory) / granule;
+      const auto end = index + size / granule;
+      Vacate(index, end);
+
+      const auto newEntry = const_cast<Allocation*>(AllocationFromIndex(index));
+      new (newEntry) Allocation {total - Allocation::GetOverhead(), this};
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         newEntry->mBlock = mBump;
+      #endif
+      Occupy(index);
+      Store(mEntries, end);
+      mBump += size;
+
+      mAllocatedByFrontend += total;
       IF_LANGULUS_MEMORY_STATISTICS(++mValidEntries);
       return newEntry;
    }
@@ -183,52 +458,196 @@ namespace Langulus::Fractalloc
          "Removing an invalid entry");
       LANGULUS_ASSUME(DevAssumes, mEntries,
          "Bad valid entry count");
-      LANGULUS_ASSUME(DevAssumes, mAllocatedByFrontend >= entry->GetTotalSize(),
+      LANGULUS_ASSUME(DevAssumes, mAllocatedByFrontend >= GetEntrySize(entry),
          "Bad frontend allocation size");
 
-      mAllocatedByFrontend -= entry->GetTotalSize();
+      const auto index = IndexFromEntry(entry);
+      const auto total = GetEntrySize(entry);
+      mAllocatedByFrontend -= total;
       entry->mReferences = 0;
+      Decommit(index, total);
 
       if (0 == mAllocatedByFrontend) {
          // The freed entry was the last used entry                     
-         // Reset the entire pool                                       
-         mThreshold = mThresholdPrevious = mAllocatedByBackend;
-         mThresholdMin = Allocation::GetMinAllocation();
-         mLastFreed = nullptr;
-         mEntries = 0;
-         IF_LANGULUS_MEMORY_STATISTICS(mValidEntries = 0);
+         Reset();
+      }
+      else if (mBump) {
+         // Stacks have no freed lists - if the entry was on top, the   
+         // stack shrinks down to the end of the used entry below it,   
+         // which exists, because the pool is still in use              
+         constexpr Offset granule = GetBumpGranule();
+         Vacate(index);
+         if (BlockFromIndex(index) + ((total + granule - 1) & ~(granule - 1)) == mBump) {
+            const auto below = PrevOccupied(index - 1);
+            const auto size = GetEntrySize(AllocationFromIndex(below));
+            const auto end = below + (size + granule - 1) / granule;
+            Store(mEntries, end);
+            mBump = BlockFromIndex(end);
+         }
+         IF_LANGULUS_MEMORY_STATISTICS(--mValidEntries);
       }
       else {
-         // Push the removed entry to the last freed list               
+         // Push the removed entry to the freed list of its level       
          // The removed entry becomes the last freed entry, and its     
          // pool pointer becomes a jump to the previous last freed      
-         entry->mNextFreeEntry = mLastFreed;
-         mLastFreed = entry;
+         PushFreed(entry, index);
+         Vacate(index);
+
+         if (mSlot)
+            Store(mThreshold, mSlot);
+         else
+            DelSize(total);
          IF_LANGULUS_MEMORY_STATISTICS(--mValidEntries);
+      }
+   }
+
+   /// Forget all entries at once, as if they were all deallocated            
+   /// The cost depends only on how many entries the pool ever had, because   
+   /// only the occupancy bitmap is cleared - headers are left as they are,   
+   /// and are overwritten by the next allocations. Pools filled like a       
+   /// stack don't even clear the bitmap - Bump clears it as it goes, so      
+   /// they're reset in constant time                                         
+   ///   @attention entries are no longer valid after this, but their pages   
+   ///      remain committed                                                  
+   LANGULUS(INLINED)
+   void Pool::Reset() noexcept {
+      if (mBump) {
+         mBump = mMemory;
+         mAllocatedByFrontend = 0;
+         Store(mEntries, 0);
+         IF_LANGULUS_MEMORY_STATISTICS(mValidEntries = 0);
+         return;
+      }
+
+      if (mSlot) {
+         Store(mThreshold, mSlot);
+         mThresholdPrevious = mThresholdMin = mSlot;
+      }
+      else {
+         Store(mThreshold, mAllocatedByBackend);
+         mThresholdPrevious = mAllocatedByBackend;
+         mThresholdMin = Allocation::GetMinAllocation();
+      }
+      mAllocatedByFrontend = 0;
+      mSizeLevels = 0;
+      mFreedLevels = 0;
+      VacateAll();
+      Store(mEntries, 0);
+      IF_LANGULUS_MEMORY_STATISTICS(mValidEntries = 0);
+   }
+
+   /// Queue an entry, that was freed by a thread not owning the pool         
+   /// The entry remains in use, until the owner drains the queue             
+   /// This is lock-free, and safe to call from any number of threads         
+   ///   @attention assumes entry is valid                                    
+   ///   @param entry - entry to queue                                        
+   ///   @return true if queued, false if the pool is no longer claimed, in   
+   ///      which case the entry must be deallocated under Allocator lock     
+   LANGULUS(INLINED)
+   bool Pool::PushRemote(Allocation* entry) noexcept {
+      return PushRemote({&entry, 1});
+   }
+
+   /// Queue a run of entries, that were freed by a thread not owning the     
+   /// pool, with a single exchange, no matter how many they are              
+   /// The entries are linked only once the pool is seen accepting them       
+   ///   @attention assumes entries are valid, and there's at least one       
+   ///   @param run - the entries to queue                                    
+   ///   @return true if queued, false if the pool is no longer claimed, in   
+   ///      which case the headers of the entries are left as they were,      
+   ///      and the entries must be deallocated under Allocator lock          
+   LANGULUS(INLINED)
+   bool Pool::PushRemote(::std::span<Allocation* const> run) noexcept {
+      auto head = mRemoteFreed.load(::std::memory_order_relaxed);
+      if (head == RemoteClosed())
+         return false;
+
+      for (Count i = 1; i < run.size(); ++i)
+         run[i - 1]->SetNextFree(run[i]);
+
+      do {
+         if (head == RemoteClosed()) {
+            // The owner gave the pool back in the meantime, so the     
+            // links must go, before anyone reads the entries again     
+            for (auto entry : run)
+               entry->SetPool(this);
+            return false;
+         }
+         run.back()->SetNextFree(head);
+      }
+      while (not mRemoteFreed.compare_exchange_weak(head, run.front(),
+         ::std::memory_order_release, ::std::memory_order_relaxed));
+      return true;
+   }
+
+   /// Recycle all entries that were freed by other threads, in one batch     
+   /// Does nothing, if the pool isn't claimed                                
+   ///   @attention must be called by the owner, or under Allocator lock      
+   ///      if the pool isn't claimed                                         
+   inline void Pool::DrainRemote() IF_UNSAFE(noexcept) {
+      auto entry = mRemoteFreed.load(::std::memory_order_relaxed);
+      if (not entry or entry == RemoteClosed())
+         return;
+
+      RecycleRemote(mRemoteFreed.exchange(nullptr, ::std::memory_order_acquire));
+   }
+
+   /// Start accepting entries from other threads, when the pool is claimed   
+   ///   @attention must be called under Allocator lock                       
+   LANGULUS(INLINED)
+   void Pool::OpenRemote() noexcept {
+      mRemoteFreed.store(nullptr, ::std::memory_order_relaxed);
+   }
+
+   /// Stop accepting entries from other threads, and recycle the ones that   
+   /// were already queued, when the pool is no longer claimed. Threads that  
+   /// fail to queue an entry after this wait for the Allocator lock, so no   
+   /// entry is left behind, where nobody would recycle it                    
+   ///   @attention must be called by the owner, under Allocator lock         
+   LANGULUS(INLINED)
+   void Pool::CloseRemote() IF_UNSAFE(noexcept) {
+      const auto entry = mRemoteFreed.exchange(RemoteClosed(), ::std::memory_order_acquire);
+      if (entry != RemoteClosed())
+         RecycleRemote(entry);
+   }
 
-         //TODO: keep track of size distrubution, 
-         // shrink min threshold if all leading buckets go empty
+   /// Deallocate a list of entries, that were queued by other threads        
+   ///   @param entry - the first entry of the list, might be nullptr         
+   inline void Pool::RecycleRemote(Allocation* entry) IF_UNSAFE(noexcept) {
+      while (entry) {
+         const auto next = entry->GetNextFree();
+         entry->SetPool(this);
+         Deallocate(entry);
+         entry = next;
       }
    }
 
+   /// The remote stack of a pool, that isn't claimed                         
+   ///   @return a sentinel, that is never a valid entry                      
+   LANGULUS(INLINED)
+   Allocation* Pool::RemoteClosed() noexcept {
+      return reinterpret_cast<Allocation*>(Pointer {1});
+   }
+
    /// Resize an entry                                                        
    ///   @param entry - entry to resize                                       
    ///   @param bytes - new number of bytes                                   
    ///   @return true if entry was enlarged without conflict                  
    inline bool Pool::Reallocate(Allocation* entry, const Offset bytes) IF_UNSAFE(noexcept) {
       LANGULUS_ASSUME(DevAssumes,
-         bytes and Contains(entry) and entry and entry->GetUses(),
+         bytes and entry and Contains(entry->GetBlockStart()) and entry->GetUses(),
          "Invalid reallocation");
 
       if (bytes > entry->mAllocatedBytes) {
          // We're enlarging the entry                                   
-         // Make sure we don't violate threshold                        
+         // Make sure we don't violate threshold, or the slab entry     
+         // Stacks have no threshold, so their entries never grow       
          const auto addition = bytes - entry->mAllocatedBytes;
-         const auto newtotal = entry->GetTotalSize() + addition;
-         if (newtotal > mThreshold)
+         const auto newtotal = GetEntrySize(entry) + addition;
+         if (newtotal > (mSlot ? mSlot : mThreshold))
             return false;
 
-         if (newtotal > mThresholdMin)
+         if (not mSlot and newtotal > mThresholdMin)
             mThresholdMin = Roof2(newtotal);
 
          mAllocatedByFrontend += addition;
@@ -240,12 +659,16 @@ namespace Langulus::Fractalloc
          LANGULUS_ASSUME(DevAssumes, mAllocatedByFrontend >= removal,
             "Bad frontend allocation size");
          mAllocatedByFrontend -= removal;
-
-         //TODO: keep track of size distrubution, 
-         // shrink min threshold if all leading buckets go empty
       }
 
-      entry->mAllocatedBytes = bytes;
+      // Move the entry to its new size bucket - add first, so that     
+      // mThresholdMin never dips below the entry                       
+      const auto oldtotal = GetEntrySize(entry);
+      entry->mAllocatedBytes = static_cast<decltype(entry->mAllocatedBytes)>(bytes);
+      if (not mSlot and not mBump) {
+         AddSize(GetEntrySize(entry));
+         DelSize(oldtotal);
+      }
       return true;
    }
 
@@ -281,7 +704,7 @@ namespace Langulus::Fractalloc
       ZeroMemory(mMemory, mAllocatedByBackend);
    }
 
-   /// Touch unused memory                                                    
+   /// Touch unused memory, so that the OS maps its pages                     
    /// https://stackoverflow.com/questions/18929011                           
    LANGULUS(INLINED)
    void Pool::Touch() {
@@ -295,48 +718,112 @@ namespace Langulus::Fractalloc
    
    /// Remove all empty entries at the end and increase threshold as much     
    /// as possible                                                            
+   /// Uses the occupancy bitmap, so only unused entries are touched          
    LANGULUS(INLINED)
    void Pool::Trim() {
       LANGULUS_ASSUME(DevAssumes, mEntries, "Should have at least one entry");
 
-      const Allocation* entry;
-      Count ecounter = mEntries;
-      do {
-         entry = AllocationFromIndex(--ecounter); //TODO could be optimized further
-         if (entry->mReferences)
-            break;
+      const auto last = LastOccupied();
+      if (mSlot) {
+         // Slab entries are all the same, so unused ones are chained   
+         // in order, on a single level                                 
+         Store(mEntries, last == InvalidIndex ? 0 : last + 1);
+
+         Allocation* tail = nullptr;
+         for (auto i = NextVacant(0); i != InvalidIndex; i = NextVacant(i + 1)) {
+            const auto entry = const_cast<Allocation*>(AllocationFromIndex(i));
+            if (tail)
+               tail->SetNextFree(entry);
+            else
+               mFreed[0] = entry;
+            tail = entry;
+         }
+
+         if (tail)
+            tail->SetNextFree(nullptr);
+         mFreedLevels = tail ? 1 : 0;
+         UpdateSlab();
+
+         // Give back the pages after the last used entry               
+         const auto end = BlockFromIndex(mEntries);
+         if (end < mMemoryEnd)
+            Decommit(mEntries, mMemoryEnd - end);
+         return;
       }
-      while (ecounter > 0);
 
-      mEntries = ecounter + 1;
+      Store(mEntries, last == InvalidIndex ? 1 : last + 1);
 
-      // Scan all unused entries up to mEntries and chain them          
-      mLastFreed = nullptr;
-      ecounter = 0;
-      do {
-         entry = AllocationFromIndex(ecounter);
-         if (not entry->mReferences) {
-            mLastFreed = const_cast<Allocation*>(entry);
-            break;
+      // Chain all unused entries up to mEntries, in order, each to the 
+      // freed list of its level                                        
+      Allocation* tails[Levels];
+      mFreedLevels = 0;
+      for (auto i = NextVacant(0); i < mEntries - 1; i = NextVacant(i + 1)) {
+         const auto entry = const_cast<Allocation*>(AllocationFromIndex(i));
+         const auto level = LevelFromIndex(i);
+         const auto bit = Offset {1} << level;
+         if (not (mFreedLevels & bit)) {
+            mFreedLevels |= bit;
+            mFreed[level] = entry;
          }
-      } while (++ecounter < mEntries - 1);
+         else tails[level]->SetNextFree(entry);
 
-      auto prev = mLastFreed;
-      while (++ecounter < mEntries - 1) {
-         entry = AllocationFromIndex(ecounter);
-         if (entry->mReferences)
-            continue;
-
-         prev->mNextFreeEntry = const_cast<Allocation*>(entry);
-         prev = prev->mNextFreeEntry;
+         tails[level] = entry;
       }
 
-      if (prev)
-         prev->mNextFreeEntry = nullptr;
+      for (auto levels = mFreedLevels; levels; levels &= levels - 1)
+         tails[::std::countr_zero(levels)]->SetNextFree(nullptr);
 
-      mThreshold = ThresholdFromIndex(mEntries - 1);
+      Store(mThreshold, ThresholdFromIndex(mEntries - 1));
       mThresholdPrevious = mThreshold != mAllocatedByBackend
          ? Offset {mThreshold * 2} : mThreshold;
+
+      if (mThreshold >= DecommitThreshold) {
+         // Give back the pages of the unused entries, including the    
+         // rest of the last level, that is above the trimmed carriage  
+         for (auto i = NextVacant(0); i != InvalidIndex; i = NextVacant(i + 1))
+            Decommit(i, mThreshold);
+
+         const auto end = Offset {1} << LevelFromIndex(mEntries - 1);
+         for (auto i = mEntries; i < end; ++i)
+            Decommit(i, mThreshold);
+      }
+   }
+
+   /// Let the OS reclaim the pages behind an unused entry, if the range is   
+   /// big enough. The entry header is never decommitted, because it might    
+   /// link to other freed entries - with LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+   /// the link is right after the header, in slabs it is at the start of     
+   /// the slot, and with LANGULUS_FRACTALLOC(DETACHED_HEADERS) there's       
+   /// nothing to keep. The pages remain reserved for the pool, and are       
+   /// recommitted when touched again                                         
+   ///   @attention assumes entry is not used, and bytes don't exceed its     
+   ///      capacity                                                          
+   ///   @param index - the index of the unused entry                         
+   ///   @param bytes - the bytes after the entry start, that are unused      
+   LANGULUS(INLINED)
+   void Pool::Decommit(Offset index, Offset bytes) const noexcept {
+      if (bytes < DecommitThreshold)
+         return;
+
+      const auto page = GetPageSize();
+      const auto start = reinterpret_cast<Pointer>(BlockFromIndex(index));
+      const auto header = mSlot
+         ? (LANGULUS_FRACTALLOC(DETACHED_HEADERS) ? 0 : sizeof(Allocation*))
+         : mBias + Allocation::GetOverhead()
+            + (LANGULUS_FRACTALLOC(COMPACT_HEADERS) ? sizeof(Allocation*) : 0);
+      const auto from = (start + header + page - 1) & ~(page - 1);
+      const auto to = (start + bytes) & ~(page - 1);
+      if (to > from)
+         DecommitPages(reinterpret_cast<void*>(from), to - from);
+   }
+
+   /// Update the threshold of a slab - it accepts entries up to its slot     
+   /// size, while it has freed entries, or room for new ones after the last  
+   LANGULUS(INLINED)
+   void Pool::UpdateSlab() noexcept {
+      const bool room = mFreedLevels
+         or (mEntries + 1) * mSlot <= mAllocatedByBackend;
+      Store(mThreshold, room ? mSlot : 0);
    }
 
    /// Get threshold associated with an index                                 
@@ -349,20 +836,47 @@ namespace Langulus::Fractalloc
    }
 
    /// Get allocation from index                                              
+   /// Slab headers are Allocation::GetSize() apart, unless                   
+   /// LANGULUS_FRACTALLOC(DETACHED_HEADERS), so that compact headers can     
+   /// still tell their distance from the pool                                
    ///   @param index - the index                                             
    ///   @return the allocation (not validated and constrained)               
    LANGULUS(INLINED)
    const Allocation* Pool::AllocationFromIndex(Offset index) const noexcept {
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         return mHeaders + index;
+      #else
+         if (mSlot) {
+            return reinterpret_cast<const Allocation*>(
+               reinterpret_cast<const Byte*>(mHeaders) + index * Allocation::GetSize());
+         }
+         return reinterpret_cast<const Allocation*>(BlockFromIndex(index) + mBias);
+      #endif
+   }
+
+   /// Get the start of the memory of an entry from index, that is, where     
+   /// the entry header is, unless LANGULUS_FRACTALLOC(DETACHED_HEADERS),     
+   /// the pool is a slab, or the pool is aligned, in which case the header   
+   /// comes after mBias                                                      
+   ///   @param index - the index                                             
+   ///   @return the start of the entry (not validated and constrained)       
+   LANGULUS(INLINED)
+   Byte* Pool::BlockFromIndex(Offset index) const noexcept {
+      if (mSlot)
+         return mMemory + index * (mSlot - Allocation::GetOverhead());
+      if (mBump)
+         return mMemory + index * GetBumpGranule();
+
       // Credit goes to Vladislav Penchev                               
       if (index == 0)
-         return reinterpret_cast<const Allocation*>(mMemory);
+         return mMemory;
 
       constexpr Offset one = 1;
       const Offset basePower = Inner::FastLog2(index);
       const Offset baselessIndex = index - (one << basePower);
       const Offset levelIndex = (baselessIndex << one) + one;
       const Offset levelSize = (one << (mAllocatedByBackendLSB - basePower));
-      return reinterpret_cast<const Allocation*>(mMemory + levelIndex * levelSize);
+      return mMemory + levelIndex * levelSize;
    }
 
    /// Get index from address                                                 
@@ -373,15 +887,24 @@ namespace Langulus::Fractalloc
    Offset Pool::IndexFromAddress(const void* ptr) const IF_UNSAFE(noexcept) {
       LANGULUS_ASSUME(DevAssumes, Contains(ptr), "Entry outside pool");
 
-      // Credit goes to Yasen Vidolov (G1)                              
+      // Slab entries are found with a single division                  
       const Offset i = static_cast<const Byte*>(ptr) - mMemory;
-      if (i < mThreshold or 0 == mEntries)
+      if (mSlot)
+         return i / (mSlot - Allocation::GetOverhead());
+
+      // Stack entries are found by ValidateIndex, from their granule   
+      if (mBump)
+         return i / GetBumpGranule();
+
+      // Credit goes to Yasen Vidolov (G1)                              
+      const auto entries = Load(mEntries);
+      if (i < Load(mThreshold) or 0 == entries)
          return 0;
 
       // We got the index, but it is not constrained to the pool        
       constexpr Offset one = 1;
       Offset index = ((mAllocatedByBackend + i) / (i & ~(i - one)) - one) >> one;
-      while (index >= mEntries)
+      while (index >= entries)
          index = UpIndex(index);
       return index;
    }
@@ -393,16 +916,25 @@ namespace Langulus::Fractalloc
    LANGULUS(INLINED)
    Offset Pool::ValidateIndex(Offset index) const noexcept {
       // Pool is empty, so search is pointless                          
-      if (mEntries == 0)
+      const auto entries = Load(mEntries);
+      if (entries == 0)
          return InvalidIndex;
 
+      // Slab entries don't contain each other, so there's nothing to   
+      // step up to                                                     
+      if (mSlot)
+         return index < entries and IsOccupied(index) ? index : InvalidIndex;
+
+      // Stack entries start at the closest used granule below          
+      if (mBump)
+         return PrevOccupied(::std::min(index, entries - 1));
+
       // Step up until a valid entry inside bounds is hit               
-      while (index != 0 and (index >= mEntries
-                         or 0 == AllocationFromIndex(index)->GetUses()))
+      while (index != 0 and (index >= entries or not IsOccupied(index)))
          index = UpIndex(index);
 
       // Check if we reached root of pool and it is unused              
-      if (index == 0 and 0 == reinterpret_cast<const Allocation*>(mMemory)->GetUses())
+      if (index == 0 and not IsOccupied(0))
          return InvalidIndex;
       return index;
    }
@@ -416,15 +948,269 @@ namespace Langulus::Fractalloc
       return index >> (Inner::LSB(index) + Offset {1});
    }
 
+   /// Get the index of an entry                                              
+   /// Unlike IndexFromAddress, this works only for the exact start of an     
+   /// entry, but needs no searching, nor division, unless pool is a slab     
+   ///   @attention assumes entry is in this pool                             
+   ///   @param entry - the entry                                             
+   ///   @return the index                                                    
+   LANGULUS(INLINED)
+   Offset Pool::IndexFromEntry(const Allocation* entry) const noexcept {
+      #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+         // Headers are indexed like the entries                        
+         return entry - mHeaders;
+      #else
+         if (mSlot) {
+            return Offset(reinterpret_cast<const Byte*>(entry)
+               - reinterpret_cast<const Byte*>(mHeaders)) / Allocation::GetSize();
+         }
+
+         const Offset i = reinterpret_cast<const Byte*>(entry) - mBias - mMemory;
+         if (mBump)
+            return i / GetBumpGranule();
+         if (i == 0)
+            return 0;
+
+         // Same as in IndexFromAddress, but dividing by the lowest set 
+         // bit is just a shift                                         
+         return (((mAllocatedByBackend + i) >> ::std::countr_zero(i)) - Offset {1}) >> Offset {1};
+      #endif
+   }
+
+   /// Get the fractal level of an index                                      
+   ///   @param index - the index                                             
+   ///   @return 0 for the root entry, L for entries in [2^(L-1), 2^L)        
+   LANGULUS(INLINED)
+   Offset Pool::LevelFromIndex(Offset index) noexcept {
+      return ::std::bit_width(index);
+   }
+
+   /// Push a freed entry to the freed list of its level                      
+   /// Slabs keep all freed entries on level 0                                
+   ///   @param entry - the freed entry                                       
+   ///   @param index - the index of the entry                                
+   LANGULUS(INLINED)
+   void Pool::PushFreed(Allocation* entry, Offset index) noexcept {
+      const auto level = mSlot ? Offset {0} : LevelFromIndex(index);
+      const auto bit = Offset {1} << level;
+      entry->SetNextFree((mFreedLevels & bit) ? mFreed[level] : nullptr);
+      mFreed[level] = entry;
+      mFreedLevels |= bit;
+   }
+
+   /// Pop a freed entry from the shallowest level that has any               
+   /// All entries in [0-mEntries) can contain up to mThreshold bytes, no     
+   /// matter their level, so the level doesn't decide what fits. Instead     
+   /// shallow entries are preferred, so that used entries gather at low      
+   /// indices, and Trim can give back bigger thresholds more often           
+   ///   @attention assumes there's at least one freed entry                  
+   ///   @return the freed entry                                              
+   LANGULUS(INLINED)
+   Allocation* Pool::PopFreed() noexcept {
+      const auto level = ::std::countr_zero(mFreedLevels);
+      const auto entry = mFreed[level];
+      mFreed[level] = entry->GetNextFree();
+      if (not mFreed[level])
+         mFreedLevels &= mFreedLevels - 1;
+      return entry;
+   }
+
+   /// Account for used entries in the size distribution                      
+   ///   @param bytes - total size of each entry                              
+   ///   @param count - the number of entries                                 
+   LANGULUS(INLINED)
+   void Pool::AddSize(Offset bytes, Count count) noexcept {
+      const auto level = ::std::bit_width(bytes - 1);
+      const auto bit = Offset {1} << level;
+      if (mSizeLevels & bit)
+         mSizes[level] += count;
+      else {
+         mSizes[level] = count;
+         mSizeLevels |= bit;
+      }
+   }
+
+   /// Remove a used entry from the size distribution                         
+   /// If that was the last entry of the biggest size, mThresholdMin drops    
+   /// to the next biggest size that is still in use, so that the pool can    
+   /// continue accepting small entries                                       
+   ///   @param bytes - total size of the entry                               
+   LANGULUS(INLINED)
+   void Pool::DelSize(Offset bytes) noexcept {
+      const auto level = ::std::bit_width(bytes - 1);
+      const auto bit = Offset {1} << level;
+      if (--mSizes[level])
+         return;
+
+      mSizeLevels &= ~bit;
+      if (mSizeLevels < bit) {
+         // The biggest entries are gone                                
+         const auto biggest = mSizeLevels
+            ? Offset {1} << (::std::bit_width(mSizeLevels) - 1) : Offset {0};
+         mThresholdMin = ::std::min(mThresholdMin,
+            ::std::max(biggest, Allocation::GetMinAllocation()));
+      }
+   }
+
+   /// Check if the entry at an index is in use                               
+   /// If it is, its header is complete, even if another thread made it       
+   ///   @param index - the index                                             
+   ///   @return true if entry is in use                                      
+   LANGULUS(INLINED)
+   bool Pool::IsOccupied(Offset index) const noexcept {
+      const auto word = Load(mOccupancy[index / BitsPerWord], ::std::memory_order_acquire);
+      return (word >> (index % BitsPerWord)) & Offset {1};
+   }
+
+   /// Mark the entry at an index as used                                     
+   ///   @attention the header of the entry must be complete, it is           
+   ///      published to searching threads by this                            
+   ///   @param index - the index                                             
+   LANGULUS(INLINED)
+   void Pool::Occupy(Offset index) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, index < GetOccupancySize(mAllocatedByBackend) * 8,
+         "Index outside the occupancy bitmap");
+      auto& word = mOccupancy[index / BitsPerWord];
+      Store(word, word | (Offset {1} << (index % BitsPerWord)), ::std::memory_order_release);
+   }
+
+   /// Mark the entry at an index as unused                                   
+   ///   @param index - the index                                             
+   LANGULUS(INLINED)
+   void Pool::Vacate(Offset index) noexcept {
+      auto& word = mOccupancy[index / BitsPerWord];
+      Store(word, word & ~(Offset {1} << (index % BitsPerWord)));
+   }
+
+   /// Mark a range of entries as unused, a word at a time                    
+   /// Only words that have any of the bits set are written                   
+   ///   @param from - the first index (inclusive)                            
+   ///   @param to - the last index (exclusive)                               
+   LANGULUS(INLINED)
+   void Pool::Vacate(Offset from, Offset to) noexcept {
+      while (from < to) {
+         const auto shift = from % BitsPerWord;
+         const auto count = ::std::min(to - from, BitsPerWord - shift);
+         const auto mask = (count == BitsPerWord
+            ? ~Offset {0} : (Offset {1} << count) - Offset {1}) << shift;
+         auto& word = mOccupancy[from / BitsPerWord];
+         if (word & mask)
+            Store(word, word & ~mask);
+         from += count;
+      }
+   }
+
+   /// Mark all entries up to mEntries as unused                              
+   LANGULUS(INLINED)
+   void Pool::VacateAll() noexcept {
+      const auto words = (mEntries + BitsPerWord - 1) / BitsPerWord;
+      for (Offset word = 0; word < words; ++word)
+         Store(mOccupancy[word], 0);
+   }
+
+   /// Read a word of bookkeeping, that might be written concurrently, by     
+   /// the thread that modifies the pool, while another one searches it       
+   ///   @param word - the word to read                                       
+   ///   @param order - the memory order of the read                          
+   ///   @return the value                                                    
+   LANGULUS(INLINED)
+   Offset Pool::Load(const Offset& word, ::std::memory_order order) noexcept {
+      return ::std::atomic_ref {const_cast<Offset&>(word)}.load(order);
+   }
+
+   /// Write a word of bookkeeping, that might be read concurrently, by a     
+   /// thread that searches the pool                                          
+   ///   @param word - the word to write                                      
+   ///   @param value - the value to write                                    
+   ///   @param order - the memory order of the write                         
+   LANGULUS(INLINED)
+   void Pool::Store(Offset& word, Offset value, ::std::memory_order order) noexcept {
+      ::std::atomic_ref {word}.store(value, order);
+   }
+
+   /// Find the first used entry, starting from an index                      
+   ///   @param index - the index to start from (inclusive)                   
+   ///   @return the index of the used entry, or InvalidIndex if none         
+   LANGULUS(INLINED)
+   Offset Pool::NextOccupied(Offset index) const noexcept {
+      while (index < mEntries) {
+         const auto word = mOccupancy[index / BitsPerWord] >> (index % BitsPerWord);
+         if (word) {
+            index += ::std::countr_zero(word);
+            return index < mEntries ? index : InvalidIndex;
+         }
+
+         index = (index / BitsPerWord + 1) * BitsPerWord;
+      }
+
+      return InvalidIndex;
+   }
+
+   /// Find the first unused entry, starting from an index                    
+   ///   @param index - the index to start from (inclusive)                   
+   ///   @return the index of the unused entry, or InvalidIndex if none       
+   LANGULUS(INLINED)
+   Offset Pool::NextVacant(Offset index) const noexcept {
+      while (index < mEntries) {
+         const auto word = ~mOccupancy[index / BitsPerWord] >> (index % BitsPerWord);
+         if (word) {
+            index += ::std::countr_zero(word);
+            return index < mEntries ? index : InvalidIndex;
+         }
+
+         index = (index / BitsPerWord + 1) * BitsPerWord;
+      }
+
+      return InvalidIndex;
+   }
+
+   /// Find the last used entry, starting from an index and going down        
+   /// Safe to call while another thread modifies the pool, like IsOccupied   
+   ///   @param index - the index to start from (inclusive)                   
+   ///   @return the index of the used entry, or InvalidIndex if none         
+   LANGULUS(INLINED)
+   Offset Pool::PrevOccupied(Offset index) const noexcept {
+      auto word = index / BitsPerWord;
+      const auto shift = BitsPerWord - 1 - index % BitsPerWord;
+      auto bits = Load(mOccupancy[word], ::std::memory_order_acquire) << shift >> shift;
+      while (not bits) {
+         if (word == 0)
+            return InvalidIndex;
+         bits = Load(mOccupancy[--word], ::std::memory_order_acquire);
+      }
+
+      return word * BitsPerWord + (BitsPerWord - 1 - ::std::countl_zero(bits));
+   }
+
+   /// Find the last used entry                                               
+   ///   @return the index of the used entry, or InvalidIndex if none         
+   LANGULUS(INLINED)
+   Offset Pool::LastOccupied() const noexcept {
+      auto word = (mEntries + BitsPerWord - 1) / BitsPerWord;
+      while (word > 0) {
+         const auto bits = mOccupancy[--word];
+         if (bits)
+            return word * BitsPerWord + (BitsPerWord - 1 - ::std::countl_zero(bits));
+      }
+
+      return InvalidIndex;
+   }
+
    /// Check if a memory address resigns inside pool's range                  
+   /// The headers of a slab aren't client memory, so they're outside it      
    ///   @param address - address to check                                    
    ///   @return true if address belongs to this pool                         
    LANGULUS(INLINED)
    bool Pool::Contains(const void* address) const noexcept {
-      return address >= mMemory and address < mMemory + mAllocatedByBackend;
+      return address >= mMemory and address < mMemoryEnd;
    }
 
    /// Find a memory entry from pointer                                       
+   /// Safe to call from any thread, even while another one modifies the      
+   /// pool, because the bookkeeping is read atomically                       
+   ///   @attention the header of the found entry is read as it is, so the    
+   ///      result is meaningful only if that entry isn't deallocated, or     
+   ///      resized by another thread in the meantime                         
    ///   @param memory - memory pointer                                       
    ///   @return the memory entry that manages the memory pointer, or         
    ///      nullptr if memory is not ours, or is no longer used               
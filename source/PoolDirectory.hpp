@@ -0,0 +1,188 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Pool.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+
+
+namespace Langulus::Fractalloc
+{
+
+   ///                                                                        
+   ///   Pool directory                                                       
+   ///                                                                        
+   /// A two-level radix map from any address to the pool that contains it.   
+   /// The address space is split into granules, and each granule remembers   
+   /// the pools that overlap it. Since pools are never smaller than a        
+   /// granule, at most two pools can overlap any granule - one ending in     
+   /// it, and one starting in it. Lookups cost two loads and two             
+   /// Pool::Contains checks, regardless of how many pools there are.         
+   /// With LANGULUS_FRACTALLOC(ALIGNED_POOLS) granules are as big as the     
+   /// smallest pool, and each one is covered by exactly one pool, so a       
+   /// lookup is just a mask and two loads, without any range checks.         
+   /// Masking the address alone can't replace the directory: pools have      
+   /// different sizes, so the mask isn't known before the pool is found,     
+   /// and a foreign address would be masked to memory that isn't mapped      
+   /// at all, while Find and CheckAuthority must reject it safely.           
+   /// Leaves are allocated on demand and never released, because their       
+   /// number is bounded by the address range that pools ever occupied        
+   ///                                                                        
+   struct PoolDirectory {
+   #if LANGULUS_FRACTALLOC(ALIGNED_POOLS)
+      // Pools are aligned to the default pool size, and are multiples  
+      // of it, so such a granule never overlaps more than one pool     
+      static constexpr Offset GranuleBits = ::std::bit_width(Pool::DefaultPoolSize) - 1;
+      static constexpr Offset PoolsPerGranule = 1;
+   #else
+      // Size of a single granule, must not exceed the smallest pool    
+      static constexpr Offset GranuleBits = 16;
+      static constexpr Offset PoolsPerGranule = 2;
+   #endif
+      static constexpr Offset Granule = Offset {1} << GranuleBits;
+
+      // Number of meaningful address bits - user space is limited to   
+      // 48 bits on all supported 64-bit architectures                  
+      static constexpr Offset AddressBits = sizeof(void*) >= 8 ? 48 : sizeof(void*) * 8;
+
+      // Granules are indexed by the remaining address bits, split      
+      // between the root and the leaves                                
+      static constexpr Offset IndexBits = AddressBits - GranuleBits;
+      static constexpr Offset LeafBits = IndexBits / 2;
+      static constexpr Offset RootBits = IndexBits - LeafBits;
+      static constexpr Offset LeafSize = Offset {1} << LeafBits;
+      static constexpr Offset RootSize = Offset {1} << RootBits;
+
+      static_assert(Pool::DefaultPoolSize >= Granule,
+         "Pools must not be smaller than a directory granule");
+
+      struct Leaf {
+         // Pools overlapping each granule of the leaf                  
+         ::std::atomic<const Pool*> mPools[LeafSize][PoolsPerGranule];
+      };
+
+      ::std::atomic<Leaf*> mRoot[RootSize] {};
+
+      NOD() bool Insert(const Pool*) IF_UNSAFE(noexcept);
+      void Remove(const Pool*) noexcept;
+      NOD() const Pool* Find(const void*) const noexcept;
+
+   private:
+      NOD() Leaf* FetchLeaf(Offset) noexcept;
+   };
+
+
+   /// Get a leaf from the root, allocating it if it doesn't exist yet        
+   ///   @param root - the root index                                         
+   ///   @return the leaf, or nullptr if out of memory                        
+   inline auto PoolDirectory::FetchLeaf(Offset root) noexcept -> Leaf* {
+      auto leaf = mRoot[root].load(::std::memory_order_acquire);
+      if (leaf)
+         return leaf;
+
+      // Zeroed memory is a valid leaf with no pools in it              
+      auto fresh = static_cast<Leaf*>(::std::calloc(1, sizeof(Leaf)));
+      if (not fresh)
+         return nullptr;
+
+      if (mRoot[root].compare_exchange_strong(leaf, fresh,
+         ::std::memory_order_acq_rel, ::std::memory_order_acquire))
+         return fresh;
+
+      // Another thread was faster                                      
+      ::std::free(fresh);
+      return leaf;
+   }
+
+   /// Register a pool in all the granules its memory overlaps                
+   ///   @attention assumes pool isn't registered yet                         
+   ///   @param pool - the pool to register                                   
+   ///   @return true if registered, false if out of memory for a leaf, in    
+   ///      which case the pool is left unregistered                          
+   inline bool PoolDirectory::Insert(const Pool* pool) IF_UNSAFE(noexcept) {
+      const auto start = reinterpret_cast<Pointer>(pool->GetPoolStart<Byte>());
+      const auto first = start >> GranuleBits;
+      const auto last = (start + pool->GetAllocatedByBackend() - 1) >> GranuleBits;
+      LANGULUS_ASSUME(DevAssumes, (last >> IndexBits) == 0,
+         "Pool is outside the address range of the directory");
+
+      for (auto granule = first; granule <= last; ++granule) {
+         const auto leaf = FetchLeaf(granule >> LeafBits);
+         if (not leaf) {
+            // Undo the granules that were already registered           
+            Remove(pool);
+            return false;
+         }
+
+         UNUSED() bool inserted = false;
+         for (auto& slot : leaf->mPools[granule & (LeafSize - 1)]) {
+            const Pool* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, pool, ::std::memory_order_release)) {
+               inserted = true;
+               break;
+            }
+         }
+
+         LANGULUS_ASSUME(DevAssumes, inserted,
+            "Too many pools overlap a single granule");
+      }
+
+      return true;
+   }
+
+   /// Unregister a pool from all the granules its memory overlaps            
+   /// Granules, that the pool isn't registered in, are skipped               
+   ///   @param pool - the pool to unregister                                 
+   inline void PoolDirectory::Remove(const Pool* pool) noexcept {
+      const auto start = reinterpret_cast<Pointer>(pool->GetPoolStart<Byte>());
+      const auto first = start >> GranuleBits;
+      const auto last = (start + pool->GetAllocatedByBackend() - 1) >> GranuleBits;
+
+      for (auto granule = first; granule <= last; ++granule) {
+         const auto leaf = mRoot[granule >> LeafBits].load(::std::memory_order_relaxed);
+         if (not leaf)
+            continue;
+
+         for (auto& slot : leaf->mPools[granule & (LeafSize - 1)]) {
+            auto expected = pool;
+            if (slot.compare_exchange_strong(expected, nullptr, ::std::memory_order_relaxed))
+               break;
+         }
+      }
+   }
+
+   /// Find the pool that contains an address                                 
+   ///   @param address - the address to search for                           
+   ///   @return the pool, or nullptr if address isn't in any pool            
+   LANGULUS(INLINED)
+   const Pool* PoolDirectory::Find(const void* address) const noexcept {
+      const auto granule = reinterpret_cast<Pointer>(address) >> GranuleBits;
+      if (granule >> IndexBits)
+         return nullptr;
+
+      const auto leaf = mRoot[granule >> LeafBits].load(::std::memory_order_acquire);
+      if (not leaf)
+         return nullptr;
+
+      auto& slots = leaf->mPools[granule & (LeafSize - 1)];
+   #if LANGULUS_FRACTALLOC(ALIGNED_POOLS)
+      // The pool covers the whole granule, if there's a pool at all    
+      return slots[0].load(::std::memory_order_acquire);
+   #else
+      for (auto& slot : slots) {
+         const auto pool = slot.load(::std::memory_order_acquire);
+         if (pool and pool->Contains(address))
+            return pool;
+      }
+
+      return nullptr;
+   #endif
+   }
+
+} // namespace Langulus::Fractalloc
@@ -0,0 +1,72 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Pool.hpp"
+
+
+namespace Langulus::Fractalloc
+{
+
+   ///                                                                        
+   ///   Memory region                                                        
+   ///                                                                        
+   /// A scoped arena for short-lived entries, that are freed all at once.    
+   /// The region keeps pools of its own, outside of any chain, and bumps     
+   /// entries in them one after another, like a stack, see Pool::MakeBump.   
+   /// Reset forgets all entries in O(pools), without visiting any of them,   
+   /// and keeps the pools for the next fill; destroying the region gives     
+   /// the pools back to the OS.                                              
+   /// Entries remain ordinary pool entries, so Allocator::Find sees them for 
+   /// as long as the region lives, and they can still be deallocated one by  
+   /// one, from any thread. Region pools are claimed by Owner(), so such     
+   /// entries are queued, and recycled the next time the region bumps, or    
+   /// resets - the space is reused, only if they were on top of the stack.   
+   /// Like any arena, space left in a pool is abandoned, when an entry       
+   /// doesn't fit in it, until the next Reset                                
+   ///   @attention a region isn't thread-safe - Allocate, Reset and Release  
+   ///      must be called by one thread at a time                            
+   ///                                                                        
+   class Region final {
+   protected:
+      // All pools of the region, in the order they are filled, doubly- 
+      // linked through Pool::mNext and Pool::mPrev                     
+      Pool* mPools {};
+      Pool* mLast {};
+      // The pool currently being filled - the pools before it are      
+      // considered full until the next Reset                           
+      Pool* mCurrent {};
+      // Meta data to associate the pools with                          
+      DMeta mMeta {};
+      // Usable bytes of each pool, except for ones made for entries    
+      // that are too big for it                                        
+      Offset mPoolSize {};
+
+   public:
+      Region(const Region&) = delete;
+      Region& operator = (const Region&) = delete;
+
+      Region(DMeta = {}, Offset = Pool::DefaultPoolSize) noexcept;
+      Region(Region&&) noexcept;
+      ~Region();
+
+      NOD() Allocation* Allocate(Offset) IF_UNSAFE(noexcept);
+      void Reset() IF_UNSAFE(noexcept);
+      void Release() IF_UNSAFE(noexcept);
+
+      NOD() Count GetPoolCount() const noexcept;
+      NOD() Offset GetAllocatedByBackend() const noexcept;
+      NOD() Offset GetAllocatedByFrontend() const noexcept;
+      NOD() bool Contains(const void*) const noexcept;
+
+      NOD() static const ThreadCache* Owner() noexcept;
+
+   protected:
+      void Link(Pool*, Pool*) noexcept;
+   };
+
+} // namespace Langulus::Fractalloc
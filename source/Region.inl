@@ -0,0 +1,190 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Region.hpp"
+
+
+namespace Langulus::Fractalloc
+{
+
+   /// Create an empty region - no pools are made until the first entry       
+   ///   @param hint - optional meta data to associate pools with             
+   ///   @param size - the usable bytes of each pool, rounded up to a         
+   ///      power-of-two, never smaller than the default pool size, and       
+   ///      never bigger than Pool::MaxPoolSize                               
+   LANGULUS(INLINED)
+   Region::Region(DMeta hint, Offset size) noexcept
+      : mMeta {hint}
+      , mPoolSize {::std::clamp(Roof2(size), Pool::DefaultPoolSize, Pool::MaxPoolSize)} {}
+
+   /// Move a region, along with all of its pools                             
+   ///   @param other - the region to move                                    
+   LANGULUS(INLINED)
+   Region::Region(Region&& other) noexcept
+      : mPools {other.mPools}
+      , mLast {other.mLast}
+      , mCurrent {other.mCurrent}
+      , mMeta {other.mMeta}
+      , mPoolSize {other.mPoolSize} {
+      other.mPools = other.mLast = other.mCurrent = nullptr;
+   }
+
+   /// Give all pools back to the OS                                          
+   LANGULUS(INLINED)
+   Region::~Region() {
+      Release();
+   }
+
+   /// Allocate an entry in the region                                        
+   ///   @attention doesn't call any constructors                             
+   ///   @attention doesn't throw - check if return is nullptr                
+   ///   @attention assumes size is not zero                                  
+   ///   @param size - the number of bytes to allocate                        
+   ///   @return the allocation, or nullptr if out of memory                  
+   inline Allocation* Region::Allocate(const Offset size) IF_UNSAFE(noexcept) {
+      LANGULUS_ASSUME(DevAssumes, size, "Zero allocation is not allowed");
+
+      // Compact headers can't describe all sizes                       
+      if constexpr (LANGULUS_FRACTALLOC(COMPACT_HEADERS)) {
+         if (size > Allocation::MaxBytes)
+            return nullptr;
+      }
+
+      Allocation* memory = nullptr;
+      if (Allocation::GetNewAllocationSize(size) > mPoolSize) {
+         // Entries too big for the pools of the region get a pool of   
+         // their own, before the current one, so that it isn't         
+         // abandoned. The rest of the new pool is filled after Reset   
+         const auto pool = Allocator::AllocateBumpPool(mMeta, Allocation::GetNewAllocationSize(size));
+         if (not pool)
+            return nullptr;
+
+         Link(pool, mCurrent);
+         memory = pool->Bump(size);
+      }
+      else {
+         // Fill the current pool, then move on to the ones after it -  
+         // they're empty, because they're kept from before last Reset  
+         while (mCurrent and not (memory = mCurrent->Bump(size)))
+            mCurrent = mCurrent->mNext;
+
+         if (not memory) {
+            const auto pool = Allocator::AllocateBumpPool(mMeta, mPoolSize);
+            if (not pool)
+               return nullptr;
+
+            Link(pool, nullptr);
+            mCurrent = pool;
+            memory = pool->Bump(size);
+         }
+      }
+
+      IF_LANGULUS_MEMORY_STATISTICS(Allocator::AddEntries(1, memory->GetTotalSize()));
+      return memory;
+   }
+
+   /// Forget all entries at once, and start filling the region from its      
+   /// first pool again. No entry is visited, except the ones queued by       
+   /// Allocator::Deallocate since the last bump, and all pools are kept      
+   ///   @attention entries of the region are no longer valid after this      
+   ///   @attention doesn't call any destructors                              
+   LANGULUS(INLINED)
+   void Region::Reset() IF_UNSAFE(noexcept) {
+      for (auto pool = mPools; pool; pool = pool->mNext) {
+         // Queued entries were already taken out of the statistics     
+         pool->DrainRemote();
+         IF_LANGULUS_MEMORY_STATISTICS(Allocator::DelEntries(
+            pool->mValidEntries, pool->GetAllocatedByFrontend()));
+         pool->Reset();
+      }
+      mCurrent = mPools;
+   }
+
+   /// Give all pools of the region back to the OS                            
+   ///   @attention entries of the region are no longer valid after this      
+   ///   @attention doesn't call any destructors                              
+   LANGULUS(INLINED)
+   void Region::Release() IF_UNSAFE(noexcept) {
+      Reset();
+      while (mPools) {
+         const auto next = mPools->mNext;
+         Allocator::DeallocatePool(mPools);
+         mPools = next;
+      }
+      mLast = mCurrent = nullptr;
+   }
+
+   /// Get the number of pools in the region                                  
+   ///   @return the number of pools                                          
+   LANGULUS(INLINED)
+   Count Region::GetPoolCount() const noexcept {
+      Count count = 0;
+      for (auto pool = mPools; pool; pool = pool->mNext)
+         ++count;
+      return count;
+   }
+
+   /// Get the bytes mapped for all pools of the region                       
+   ///   @return the usable bytes of all pools                                
+   LANGULUS(INLINED)
+   Offset Region::GetAllocatedByBackend() const noexcept {
+      Offset bytes = 0;
+      for (auto pool = mPools; pool; pool = pool->mNext)
+         bytes += pool->GetAllocatedByBackend();
+      return bytes;
+   }
+
+   /// Get the bytes taken by the entries of the region                       
+   ///   @return the bytes of all entries, including their overhead           
+   LANGULUS(INLINED)
+   Offset Region::GetAllocatedByFrontend() const noexcept {
+      Offset bytes = 0;
+      for (auto pool = mPools; pool; pool = pool->mNext)
+         bytes += pool->GetAllocatedByFrontend();
+      return bytes;
+   }
+
+   /// Check if memory is inside any of the pools of the region               
+   ///   @param memory - the memory pointer                                   
+   ///   @return true if memory is in the region                              
+   LANGULUS(INLINED)
+   bool Region::Contains(const void* memory) const noexcept {
+      for (auto pool = mPools; pool; pool = pool->mNext) {
+         if (pool->Contains(memory))
+            return true;
+      }
+      return false;
+   }
+
+   /// The owner, that claims the pools of all regions - it is never a real   
+   /// thread cache, so entries are queued by every thread that frees them    
+   ///   @return a sentinel, that is never a valid thread cache               
+   LANGULUS(INLINED)
+   const ThreadCache* Region::Owner() noexcept {
+      return reinterpret_cast<const ThreadCache*>(Pointer {1});
+   }
+
+   /// Insert a pool in the region                                            
+   ///   @param pool - the pool to insert                                     
+   ///   @param before - the pool to insert before, or nullptr to append      
+   LANGULUS(INLINED)
+   void Region::Link(Pool* pool, Pool* before) noexcept {
+      pool->mNext = before;
+      pool->mPrev = before ? before->mPrev : mLast;
+      if (pool->mPrev)
+         pool->mPrev->mNext = pool;
+      else
+         mPools = pool;
+
+      if (before)
+         before->mPrev = pool;
+      else
+         mLast = pool;
+   }
+
+} // namespace Langulus::Fractalloc
@@ -0,0 +1,166 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include <Fractalloc/Allocator.hpp>
+#include <atomic>
+#include <bit>
+
+
+namespace Langulus::Fractalloc
+{
+
+   ///                                                                        
+   ///   Thread cache                                                         
+   ///                                                                        
+   /// Every thread claims a pool from each pool chain it allocates from,     
+   /// and keeps it here. Claimed pools are modified only by their owner,     
+   /// so the common Allocate/Deallocate paths take no locks. Whenever a      
+   /// claimed pool can't satisfy a request, the slow path gives it back      
+   /// to the chain and claims another one, under Allocator lock              
+   /// The cache also remembers the pools that were recently found by         
+   /// address, so that hot lookups don't touch the pool directory            
+   /// Searches by address take no locks, so each one is counted in the       
+   /// cache of the searching thread, and pools are unmapped or reused only   
+   /// after all searches, that might have found them, are over               
+   ///                                                                        
+   struct ThreadCache {
+      // Number of chains that can be cached at the same time           
+      // Chains are hashed by their Allocator::ChainKey                 
+      static constexpr Count Slots = 64;
+
+      // Requests above this size never claim pools, because they       
+      // would evict a perfectly good pool for a one-off allocation     
+      static constexpr Offset LargeRequest = Pool::DefaultPoolSize / 2;
+
+      struct Slot {
+         // The key of the chain the pool was claimed from              
+         const void* mChain;
+         // The claimed pool                                            
+         Pool* mPool;
+      };
+
+      Slot mSlots[Slots] {};
+
+      // Recently found pools are kept in a set-associative cache,      
+      // indexed by address bits, so that lookups, that alternate       
+      // between a few pools, don't evict each other                    
+      static constexpr Count RecentSets = 16;
+      static constexpr Count RecentWays = 4;
+      static constexpr Offset RecentBits = ::std::bit_width(Pool::DefaultPoolSize) - 1;
+
+      const Pool* mRecent[RecentSets][RecentWays] {};
+      // The Allocator::mPoolEpoch the recent pools were cached in      
+      // A mismatch means that some pools might no longer exist         
+      Count mRecentEpoch {};
+
+   #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+      // Frontend statistics, accumulated since the last flush          
+      // These wrap around, and are merged into Allocator::Statistics   
+      // each time the thread takes the lock                            
+      Offset mBytesAllocatedByFrontend {};
+      Count mEntries {};
+      // Searches by address, that hit or missed the recent pools       
+      Count mFindHits {};
+      Count mFindMisses {};
+   #endif
+
+      // Links in the list of all thread caches, see Allocator::mCaches 
+      ThreadCache* mNextCache {};
+      ThreadCache* mPrevCache {};
+      // Incremented when the thread begins and ends a search by        
+      // address, so it is odd while the thread searches                
+      ::std::atomic<Count> mSearches {};
+
+      // Marks a search by address in the cache, for its lifetime       
+      struct Search {
+         ThreadCache& mCache;
+
+         Search(ThreadCache&) noexcept;
+         ~Search();
+      };
+
+      ThreadCache();
+      ~ThreadCache();
+
+      NOD() Slot& SlotOf(const void*) noexcept;
+      NOD() const Pool* FindRecent(const void*, Count) noexcept;
+      void AddRecent(const void*, const Pool*) noexcept;
+   };
+
+
+   /// Begin a search by address                                              
+   ///   @param cache - the cache of the searching thread                     
+   LANGULUS(INLINED)
+   ThreadCache::Search::Search(ThreadCache& cache) noexcept
+      : mCache {cache} {
+      // Ordered with the epoch, see Allocator::WaitForSearches         
+      // Only this thread writes the counter                            
+      const auto searches = mCache.mSearches.load(::std::memory_order_relaxed);
+      mCache.mSearches.store(searches + 1, ::std::memory_order_seq_cst);
+   }
+
+   /// End the search, nothing found in it is read afterwards                 
+   LANGULUS(INLINED)
+   ThreadCache::Search::~Search() {
+      const auto searches = mCache.mSearches.load(::std::memory_order_relaxed);
+      mCache.mSearches.store(searches + 1, ::std::memory_order_release);
+   }
+
+   /// Get the cache slot for a pool chain                                    
+   ///   @param chain - the key of the chain to search for                    
+   ///   @return the slot the chain hashes to (it might be occupied by        
+   ///      another chain)                                                    
+   LANGULUS(INLINED)
+   auto ThreadCache::SlotOf(const void* chain) noexcept -> Slot& {
+      const auto hash = reinterpret_cast<Pointer>(chain) / sizeof(void*);
+      return mSlots[(hash ^ (hash >> 6)) % Slots];
+   }
+
+   /// Search the recently found pools for one containing an address          
+   /// On a hit, the pool is moved to the front of its set                    
+   ///   @param address - the address to search for                           
+   ///   @param epoch - the current Allocator::mPoolEpoch                     
+   ///   @return the pool, or nullptr on a miss                               
+   LANGULUS(INLINED)
+   const Pool* ThreadCache::FindRecent(const void* address, Count epoch) noexcept {
+      if (mRecentEpoch != epoch) {
+         // Pools were deallocated since the last search, so forget all 
+         for (auto& set : mRecent)
+            for (auto& way : set)
+               way = nullptr;
+         mRecentEpoch = epoch;
+         return nullptr;
+      }
+
+      auto& set = mRecent[(reinterpret_cast<Pointer>(address) >> RecentBits) % RecentSets];
+      for (Count way = 0; way < RecentWays and set[way]; ++way) {
+         const auto pool = set[way];
+         if (pool->Contains(address)) {
+            for (; way > 0; --way)
+               set[way] = set[way - 1];
+            set[0] = pool;
+            return pool;
+         }
+      }
+
+      return nullptr;
+   }
+
+   /// Remember a found pool, evicting the least recently found one in the    
+   /// set, if the set is full                                                
+   ///   @param address - the address the pool was found by                   
+   ///   @param pool - the pool to remember                                   
+   LANGULUS(INLINED)
+   void ThreadCache::AddRecent(const void* address, const Pool* pool) noexcept {
+      auto& set = mRecent[(reinterpret_cast<Pointer>(address) >> RecentBits) % RecentSets];
+      for (Count way = RecentWays - 1; way > 0; --way)
+         set[way] = set[way - 1];
+      set[0] = pool;
+   }
+
+} // namespace Langulus::Fractalloc
@@ -0,0 +1,158 @@
+///                                                                           
+/// Langulus::Fractalloc                                                      
+/// Copyright (c) 2015 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: MIT                                              
+///                                                                           
+#pragma once
+#include "Config.hpp"
+
+#if defined(_WIN32)
+   #ifndef WIN32_LEAN_AND_MEAN
+      #define WIN32_LEAN_AND_MEAN
+   #endif
+   #ifndef NOMINMAX
+      #define NOMINMAX
+   #endif
+   #include <windows.h>
+#else
+   #include <sys/mman.h>
+   #include <unistd.h>
+#endif
+
+
+namespace Langulus::Fractalloc
+{
+
+   /// Size of a huge page, as used by transparent huge pages on the most     
+   /// common architectures                                                   
+   constexpr Offset HugePageSize = 2 * 1024 * 1024;
+
+   /// Get the granularity of the virtual memory, provided by the OS          
+   ///   @return the page size in bytes, always a power-of-two                
+   inline Offset GetPageSize() noexcept {
+      static const Offset size = [] {
+         #if defined(_WIN32)
+            SYSTEM_INFO info;
+            ::GetSystemInfo(&info);
+            return static_cast<Offset>(info.dwPageSize);
+         #else
+            return static_cast<Offset>(::sysconf(_SC_PAGESIZE));
+         #endif
+      }();
+      return size;
+   }
+
+   /// Round a number of bytes up to whole pages                              
+   ///   @param bytes - the number of bytes                                   
+   ///   @return the rounded number of bytes                                  
+   LANGULUS(INLINED)
+   Offset RoofToPage(Offset bytes) noexcept {
+      const auto page = GetPageSize();
+      return (bytes + page - 1) & ~(page - 1);
+   }
+
+   /// Map zeroed pages directly from the OS, bypassing the heap              
+   ///   @param size - number of bytes, must be a multiple of the page size   
+   ///   @return the start of the pages, or nullptr if out of memory          
+   inline void* MapPages(Offset size) noexcept {
+      #if defined(_WIN32)
+         return ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+      #else
+         const auto memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+         return memory == MAP_FAILED ? nullptr : memory;
+      #endif
+   }
+
+   /// Give pages, mapped with MapPages, back to the OS                       
+   ///   @param memory - the start of the pages                               
+   ///   @param size - the number of bytes, as given to MapPages              
+   inline void UnmapPages(void* memory, Offset size) noexcept {
+      #if defined(_WIN32)
+         (void) size;
+         ::VirtualFree(memory, 0, MEM_RELEASE);
+      #else
+         ::munmap(memory, size);
+      #endif
+   }
+
+   /// Give the tail of some pages, mapped with MapPages, back to the OS      
+   /// The rest can still be given back with UnmapPages, as if only they      
+   /// were ever mapped                                                       
+   ///   @param memory - the start of the pages                               
+   ///   @param size - the number of bytes mapped so far                      
+   ///   @param keep - the number of bytes to keep, must be a multiple of     
+   ///      page size, and less than size                                     
+   inline void TrimPages(void* memory, Offset size, Offset keep) noexcept {
+      const auto tail = static_cast<Byte*>(memory) + keep;
+      #if defined(_WIN32)
+         // Only whole reservations can be released, so the tail stays  
+         // reserved until UnmapPages releases the rest                 
+         ::VirtualFree(tail, size - keep, MEM_DECOMMIT);
+      #else
+         ::munmap(tail, size - keep);
+      #endif
+   }
+
+   /// Ask the OS to commit physical memory for some pages right away, in a   
+   /// single system call, instead of faulting them in one by one             
+   ///   @param memory - the start of the pages, must be page-aligned         
+   ///   @param size - the number of bytes, must be a multiple of page size   
+   ///   @return true if the pages were committed                             
+   inline bool PopulatePages(void* memory, Offset size) noexcept {
+      #if defined(MADV_POPULATE_WRITE)
+         return 0 == ::madvise(memory, size, MADV_POPULATE_WRITE);
+      #else
+         (void) memory; (void) size;
+         return false;
+      #endif
+   }
+
+   /// Commit physical memory for some pages, and pin it, so that the pages   
+   /// are never swapped out, nor faulted in again                            
+   ///   @param memory - the start of the pages, must be page-aligned         
+   ///   @param size - the number of bytes, must be a multiple of page size   
+   ///   @return true if the pages were locked - this fails if the process    
+   ///      exceeds its locked memory limit                                   
+   inline bool LockPages(void* memory, Offset size) noexcept {
+      #if defined(_WIN32)
+         return ::VirtualLock(memory, size);
+      #else
+         return 0 == ::mlock(memory, size);
+      #endif
+   }
+
+   /// Ask the OS to back some pages with transparent huge pages              
+   /// The OS is free to ignore this, if huge pages are disabled, or not      
+   /// available at the time the pages are touched                            
+   ///   @param memory - the start of the pages, must be HugePageSize-aligned 
+   ///   @param size - the number of bytes, must be a multiple of HugePageSize
+   ///   @return true if the OS accepted the advice                           
+   inline bool AdviseHugePages(void* memory, Offset size) noexcept {
+      #if defined(MADV_HUGEPAGE)
+         return 0 == ::madvise(memory, size, MADV_HUGEPAGE);
+      #else
+         (void) memory; (void) size;
+         return false;
+      #endif
+   }
+
+   /// Let the OS reclaim the physical memory behind some pages, while        
+   /// keeping their address range reserved and accessible. The contents      
+   /// of the pages are undefined afterwards - they might be zeroed, or       
+   /// retained, if the OS didn't need them in the meantime                   
+   ///   @param memory - the start of the pages, must be page-aligned         
+   ///   @param size - the number of bytes, must be a multiple of page size   
+   inline void DecommitPages(void* memory, Offset size) noexcept {
+      #if defined(_WIN32)
+         ::VirtualAlloc(memory, size, MEM_RESET, PAGE_READWRITE);
+      #elif defined(MADV_FREE)
+         ::madvise(memory, size, MADV_FREE);
+      #else
+         ::madvise(memory, size, MADV_DONTNEED);
+      #endif
+   }
+
+} // namespace Langulus::Fractalloc
@@ -8,6 +8,9 @@
 #include "Main.hpp"
 #include <catch2/catch.hpp>
 #include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 
 /// See https://github.com/catchorg/Catch2/blob/devel/docs/tostring.md        
@@ -47,6 +50,10 @@ struct TypeVeryBig {
    TypeBig t8[5];
 };
 
+/// No two entries of this size fit in a default pool, even when the          
+/// allocation headers are kept outside of it                                 
+constexpr Offset HalfPool = Pool::DefaultPoolSize / 2 + 1;
+
 bool IsAligned(const void* a) noexcept {
    return 0 == (reinterpret_cast<Pointer>(a) & Pointer {Alignment - 1});
 }
@@ -190,10 +197,10 @@ SCENARIO("Testing pool functions", "[allocator]") {
          REQUIRE(IsPowerOfTwo(pool->GetMaxEntries()));
          REQUIRE(IsAligned(pool->GetPoolStart()));
          REQUIRE(pool->GetAllocatedByBackend() <= Pool::DefaultPoolSize*2);
-         REQUIRE(reinterpret_cast<Pointer>(pool->AllocationFromIndex(0)) == origin);
-         REQUIRE(reinterpret_cast<Pointer>(pool->AllocationFromIndex(1)) == origin + half);
-         REQUIRE(reinterpret_cast<Pointer>(pool->AllocationFromIndex(2)) == origin + quarter);
-         REQUIRE(reinterpret_cast<Pointer>(pool->AllocationFromIndex(3)) == origin + quarter + half);
+         REQUIRE(reinterpret_cast<Pointer>(pool->BlockFromIndex(0)) == origin);
+         REQUIRE(reinterpret_cast<Pointer>(pool->BlockFromIndex(1)) == origin + half);
+         REQUIRE(reinterpret_cast<Pointer>(pool->BlockFromIndex(2)) == origin + quarter);
+         REQUIRE(reinterpret_cast<Pointer>(pool->BlockFromIndex(3)) == origin + quarter + half);
          REQUIRE(pool->ThresholdFromIndex(1) == half);
          REQUIRE(pool->ThresholdFromIndex(2) == quarter);
          REQUIRE(pool->ThresholdFromIndex(3) == quarter);
@@ -218,6 +225,12 @@ SCENARIO("Testing pool functions", "[allocator]") {
          REQUIRE_FALSE(pool->Contains(originPtr + half * 2));
          REQUIRE_FALSE(pool->Contains(nullptr));
          REQUIRE_FALSE(pool->IsInUse());
+         #if LANGULUS_FRACTALLOC(ALIGNED_POOLS)
+            REQUIRE(origin % Pool::DefaultPoolSize == 0);
+         #endif
+         #if LANGULUS_FRACTALLOC(HUGE_PAGES)
+            REQUIRE(origin % HugePageSize == 0);
+         #endif
 
          Allocator::DeallocatePool(pool);
       }
@@ -232,17 +245,40 @@ SCENARIO("Testing pool functions", "[allocator]") {
 
          REQUIRE(pool->GetAllocatedByFrontend() == entry->GetTotalSize());
          REQUIRE(pool->GetMaxEntries() == full / smallest);
-         REQUIRE(pool->Contains(entry));
+         REQUIRE(pool->Contains(entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(pool->Contains(entry));
+         #endif
          REQUIRE(pool->IsInUse());
+         REQUIRE(entry->GetPool() == pool);
+         #if LANGULUS_FRACTALLOC(COMPACT_HEADERS)
+            REQUIRE(Allocation::GetSize() == 16);
+            REQUIRE(Allocation::GetMinAllocation() == 32);
+         #endif
+         #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            // Headers are dense, and away from the client memory       
+            REQUIRE(entry->GetBlockStart() == pool->GetPoolStart<Byte>());
+            REQUIRE_FALSE(pool->Contains(entry));
+            REQUIRE(pool->Allocate(5) == entry + 1);
+         #endif
 
          Allocator::DeallocatePool(pool);
       }
 
+      if constexpr (LANGULUS_FRACTALLOC(COMPACT_HEADERS)) {
+         WHEN("A pool, whose entries can't reach it, is requested") {
+            // Compact headers can't tell such entries' pool            
+            REQUIRE_FALSE(Allocator::AllocatePool(nullptr, Pool::MaxPoolSize * 2));
+         }
+      }
+
       WHEN("A small entry is allocated inside a new huge pool") {
-         if constexpr (Bitness == 32)
-            pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize * 1024);
+         constexpr Offset GB = 1024 * 1024 * 1024;
+         // Detached headers reserve more than the pool itself          
+         if constexpr (Bitness == 32 or LANGULUS_FRACTALLOC(DETACHED_HEADERS))
+            pool = Allocator::AllocatePool(nullptr, GB);
          else
-            pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize * 1024 * 4);
+            pool = Allocator::AllocatePool(nullptr, GB * 4);
 
          REQUIRE(pool);
 
@@ -252,7 +288,10 @@ SCENARIO("Testing pool functions", "[allocator]") {
 
          REQUIRE(pool->GetAllocatedByFrontend() == entry->GetTotalSize());
          REQUIRE(pool->GetMaxEntries() == full / smallest);
-         REQUIRE(pool->Contains(entry));
+         REQUIRE(pool->Contains(entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(pool->Contains(entry));
+         #endif
          REQUIRE(pool->IsInUse());
 
          #ifdef LANGULUS_STD_BENCHMARK // Last result: 
@@ -437,10 +476,158 @@ SCENARIO("Testing pool functions", "[allocator]") {
          REQUIRE(pool->GetMaxEntries() == full / smallest);
          for (Count i = 0; i < pool->GetMaxEntries(); ++i) {
             auto entry = pool->AllocationFromIndex(i);
-            REQUIRE(pool->Contains(entry));
+            REQUIRE(pool->Contains(entry->GetBlockStart()));
+            #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+               REQUIRE(pool->Contains(entry));
+            #endif
             REQUIRE(entry->GetUses() == 1 + i);
+            REQUIRE(pool->IndexFromEntry(entry) == i);
+            REQUIRE(pool->IsOccupied(i));
+         }
+
+         REQUIRE(pool->LastOccupied() == pool->GetMaxEntries() - 1);
+         REQUIRE(pool->NextVacant(0) == Pool::InvalidIndex);
+
+         Allocator::DeallocatePool(pool);
+      }
+
+      WHEN("Some entries are deallocated from a default-sized pool, and it is trimmed") {
+         pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
+         REQUIRE(pool);
+
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 200; ++i)
+            entries.push_back(pool->Allocate(5));
+
+         // Free every third entry, and all entries past the 100th      
+         for (Count i = 0; i < entries.size(); ++i) {
+            if (i % 3 == 0 or i >= 100)
+               pool->Deallocate(entries[i]);
          }
 
+         for (Count i = 0; i < entries.size(); ++i)
+            REQUIRE(pool->IsOccupied(i) == (i % 3 != 0 and i < 100));
+         REQUIRE(pool->NextOccupied(0) == 1);
+         REQUIRE(pool->NextOccupied(3) == 4);
+         REQUIRE(pool->NextVacant(1) == 3);
+         REQUIRE(pool->LastOccupied() == 98);
+
+         pool->Trim();
+         REQUIRE(pool->LastOccupied() == 98);
+         REQUIRE(pool->Find(entries[98]->GetBlockStart()) == entries[98]);
+         REQUIRE(pool->Find(entries[99]->GetBlockStart()) == nullptr);
+
+         // Recycled entries should come from the freed ones, in order  
+         REQUIRE(pool->Allocate(5) == entries[0]);
+         REQUIRE(pool->Allocate(5) == entries[3]);
+         REQUIRE(pool->IsOccupied(0));
+         REQUIRE(pool->IsOccupied(3));
+
+         Allocator::DeallocatePool(pool);
+      }
+
+      WHEN("Entries on different levels are deallocated from a default-sized pool") {
+         pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
+         REQUIRE(pool);
+
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 64; ++i)
+            entries.push_back(pool->Allocate(5));
+
+         pool->Deallocate(entries[2]);
+         pool->Deallocate(entries[40]);
+         pool->Deallocate(entries[9]);
+
+         // Shallowest levels are recycled first, regardless of order   
+         REQUIRE(pool->Allocate(5) == entries[2]);
+         REQUIRE(pool->Allocate(5) == entries[9]);
+         REQUIRE(pool->Allocate(5) == entries[40]);
+         REQUIRE(pool->Allocate(5) == pool->AllocationFromIndex(64));
+
+         Allocator::DeallocatePool(pool);
+      }
+
+      WHEN("The only big entry is deallocated from a default-sized pool, full of small entries") {
+         pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
+         REQUIRE(pool);
+
+         auto big = pool->Allocate(Pool::DefaultPoolSize / 64);
+         REQUIRE(big);
+         const auto bigMin = pool->GetMinAllocation();
+         REQUIRE(bigMin == Roof2(big->GetTotalSize()));
+
+         // The big entry prevents the pool from going any finer        
+         Count smallEntries = 0;
+         while (pool->Allocate(5))
+            ++smallEntries;
+         REQUIRE(smallEntries == Pool::DefaultPoolSize / bigMin - 1);
+         REQUIRE(pool->GetMinAllocation() == bigMin);
+
+         // Without it, the pool accepts small entries again            
+         pool->Deallocate(big);
+         REQUIRE(pool->GetMinAllocation() == Roof2(Allocation::GetNewAllocationSize(5)));
+
+         Count moreEntries = 0;
+         while (pool->Allocate(5))
+            ++moreEntries;
+         REQUIRE(moreEntries > smallEntries);
+
+         Allocator::DeallocatePool(pool);
+      }
+
+      WHEN("Pools are committed with each commit policy") {
+         const CommitPolicy policies[] {
+            CommitPolicy::Touch, CommitPolicy::Populate,
+            CommitPolicy::Lazy, CommitPolicy::Lock
+         };
+
+         for (auto policy : policies) {
+            Allocator::SetCommitPolicy(policy);
+            REQUIRE(Allocator::GetCommitPolicy() == policy);
+
+            pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
+            REQUIRE(pool);
+
+            auto entry = pool->Allocate(Pool::DefaultPoolSize / 4);
+            REQUIRE(entry);
+            ::std::memset(entry->GetBlockStart(), 1, entry->GetAllocatedSize());
+            REQUIRE(pool->Find(entry->GetBlockStart()) == entry);
+
+            Allocator::DeallocatePool(pool);
+         }
+
+         Allocator::SetCommitPolicy(CommitPolicy::Touch);
+      }
+
+      WHEN("Big entries are deallocated from a pool, and their pages are decommitted") {
+         pool = Allocator::AllocatePool(nullptr, Pool::DecommitThreshold * 8);
+         REQUIRE(pool);
+
+         constexpr Offset size = Pool::DecommitThreshold;
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 4; ++i) {
+            entries.push_back(pool->Allocate(size));
+            REQUIRE(entries.back());
+            ::std::memset(entries.back()->GetBlockStart(), int(i + 1), size);
+         }
+
+         // Decommit the freed entries, and everything above the carriage
+         pool->Deallocate(entries[1]);
+         pool->Deallocate(entries[3]);
+         pool->Trim();
+
+         // Used entries must be intact, and freed ones still linked    
+         bool intact = true;
+         for (Offset i = 0; i < size; ++i) {
+            intact &= entries[0]->GetBlockStart()[i].mValue == 1;
+            intact &= entries[2]->GetBlockStart()[i].mValue == 3;
+         }
+         REQUIRE(intact);
+
+         REQUIRE(pool->Allocate(size) == entries[1]);
+         ::std::memset(entries[1]->GetBlockStart(), 5, size);
+         REQUIRE(pool->Find(entries[1]->GetBlockStart() + size - 1) == entries[1]);
+
          Allocator::DeallocatePool(pool);
       }
 
@@ -452,12 +639,59 @@ SCENARIO("Testing pool functions", "[allocator]") {
          REQUIRE(pool->GetAllocatedByFrontend() == entry->GetTotalSize());
          REQUIRE(pool->GetMinAllocation() == Roof2(entry->GetTotalSize()));
          REQUIRE(pool->GetMaxEntries() == pool->GetAllocatedByBackend() / pool->GetMinAllocation());
-         REQUIRE(pool->Contains(entry));
+         REQUIRE(pool->Contains(entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(pool->Contains(entry));
+         #endif
          REQUIRE(pool->IsInUse());
 
          Allocator::DeallocatePool(pool);
       }
 
+      WHEN("Entries are allocated inside a new default-sized slab") {
+         pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
+         REQUIRE(pool);
+
+         const auto slot = Chain::SlabSize(5);
+         pool->MakeSlab(slot);
+         REQUIRE(pool->IsSlab());
+         REQUIRE(pool->GetMaxEntries() == Pool::DefaultPoolSize / slot);
+         REQUIRE_FALSE(pool->Allocate(slot - Allocation::GetOverhead() + 1));
+
+         // Entries are packed one after another, in order              
+         ::std::vector<Allocation*> entries;
+         while (auto entry = pool->Allocate(20))
+            entries.push_back(entry);
+         REQUIRE(entries.size() == Pool::DefaultPoolSize / slot);
+
+         // Slots hold only client memory - headers are kept aside      
+         const auto stride = slot - Allocation::GetOverhead();
+         bool packed = true;
+         for (Offset i = 0; i < entries.size(); ++i)
+            packed &= entries[i]->GetBlockStart() == pool->GetPoolStart<Byte>() + i * stride;
+         REQUIRE(packed);
+         REQUIRE_FALSE(pool->Contains(entries[0]));
+         REQUIRE(entries[1]->GetPool() == pool);
+
+         REQUIRE(pool->Find(entries[7]->GetBlockStart() + 19) == entries[7]);
+         REQUIRE(pool->Find(entries[7]->GetBlockStart() + 20) == nullptr);
+         REQUIRE(pool->Reallocate(entries[7], slot - Allocation::GetOverhead()));
+         REQUIRE_FALSE(pool->Reallocate(entries[7], slot - Allocation::GetOverhead() + 1));
+
+         // Trimming chains freed entries in order                      
+         const auto freed = entries[3]->GetBlockStart();
+         pool->Deallocate(entries[100]);
+         pool->Deallocate(entries[3]);
+         REQUIRE(pool->Find(freed) == nullptr);
+         pool->Trim();
+
+         REQUIRE(pool->Allocate(20) == entries[3]);
+         REQUIRE(pool->Allocate(20) == entries[100]);
+         REQUIRE_FALSE(pool->Allocate(20));
+
+         Allocator::DeallocatePool(pool);
+      }
+
       WHEN("An entry larger than the pool itself is allocated inside a new default-sized pool") {
          pool = Allocator::AllocatePool(nullptr, Pool::DefaultPoolSize);
          auto entry = pool->Allocate(Pool::DefaultPoolSize * 2);
@@ -471,6 +705,46 @@ SCENARIO("Testing pool functions", "[allocator]") {
    }
 }
 
+SCENARIO("Testing pool chains", "[allocator]") {
+   GIVEN("A pool chain") {
+      Chain chain {};
+
+      WHEN("Pools are made without any being released") {
+         THEN("The size of each new pool doubles, up to the maximum") {
+            Offset expected = Pool::DefaultPoolSize;
+            for (Count i = 0; i < 8; ++i) {
+               REQUIRE(chain.Grow() == expected);
+               expected = ::std::min(expected * 2, chain.mPoolSizeMax);
+            }
+
+            REQUIRE(chain.Grow() == Pool::DefaultPoolSize * Chain::MaxGrowth);
+         }
+      }
+
+      WHEN("Pools are released in between") {
+         UNUSED() auto size = chain.Grow();
+         size = chain.Grow();
+         size = chain.Grow();
+         REQUIRE(chain.mPoolSize == Pool::DefaultPoolSize * 8);
+
+         chain.Shrink();
+         chain.Shrink();
+
+         THEN("The next pools are smaller, and don't grow right away") {
+            REQUIRE(chain.Grow() == Pool::DefaultPoolSize * 2);
+            REQUIRE(chain.Grow() == Pool::DefaultPoolSize * 2);
+            REQUIRE(chain.Grow() == Pool::DefaultPoolSize * 4);
+         }
+
+         THEN("The pools never shrink below the minimum") {
+            for (Count i = 0; i < 8; ++i)
+               chain.Shrink();
+            REQUIRE(chain.Grow() == Pool::DefaultPoolSize);
+         }
+      }
+   }
+}
+
 SCENARIO("Testing allocator functions", "[allocator]") {
    GIVEN("An allocation") {
       Allocation* entry = nullptr;
@@ -483,12 +757,16 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          REQUIRE(entry);
          REQUIRE(entry->GetBlockStart() != nullptr);
          REQUIRE(entry->GetBlockStart() != reinterpret_cast<Byte*>(entry));
-         REQUIRE(reinterpret_cast<Pointer>(entry) % Alignment == 0);
          REQUIRE(reinterpret_cast<Pointer>(entry->GetBlockStart()) % Alignment == 0);
          REQUIRE(entry->GetAllocatedSize() >= 512);
          REQUIRE(entry->GetBlockEnd() == entry->GetBlockStart() + entry->GetAllocatedSize());
          REQUIRE(entry->GetSize() % Alignment == 0);
-         REQUIRE(entry->GetBlockStart() == reinterpret_cast<Byte*>(entry) + entry->GetSize());
+         #if LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE_FALSE(entry->GetPool()->Contains(entry));
+         #else
+            REQUIRE(reinterpret_cast<Pointer>(entry) % Alignment == 0);
+            REQUIRE(entry->GetBlockStart() == reinterpret_cast<Byte*>(entry) + entry->GetSize());
+         #endif
          REQUIRE(entry->GetUses() == 1);
          for (Offset i = 0; i < 512; ++i) {
             auto p = entry->GetBlockStart() + i;
@@ -608,7 +886,10 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          entry->Keep();
 
          REQUIRE(entry->GetUses() == 2);
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
 
@@ -625,7 +906,10 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          entry->Keep(5);
 
          REQUIRE(entry->GetUses() == 6);
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
 
@@ -643,7 +927,10 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          entry->Free();
 
          REQUIRE(entry->GetUses() == 1);
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
 
@@ -659,7 +946,10 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          entry->Free(4);
 
          REQUIRE(entry->GetUses() == 2);
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
 
@@ -675,7 +965,10 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          REQUIRE(entry);
          Allocator::Deallocate(entry);
 
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE_FALSE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
       }
@@ -691,9 +984,812 @@ SCENARIO("Testing allocator functions", "[allocator]") {
          entry->Free(5);
          Allocator::Deallocate(entry);
 
-         REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         REQUIRE(Allocator::CheckAuthority(nullptr, entry->GetBlockStart()));
+         #if not LANGULUS_FRACTALLOC(DETACHED_HEADERS)
+            REQUIRE(Allocator::CheckAuthority(nullptr, entry));
+         #endif
          REQUIRE_FALSE(Allocator::Find(nullptr, entry->GetBlockStart()));
          REQUIRE_FALSE(Allocator::Find(nullptr, entry));
       }
+
+      WHEN("Searched for across many pools") {
+         Allocator::CollectGarbage();
+
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 64; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto hits = Allocator::GetStatistics().mFindHits;
+         #endif
+
+         for (auto e : entries) {
+            REQUIRE(Allocator::CheckAuthority(nullptr, e->GetBlockStart()));
+            REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            // Each Find should've hit the pool, found by CheckAuthority
+            REQUIRE(Allocator::GetStatistics().mFindHits >= hits + entries.size());
+         #endif
+
+         // Search for all of them at once, mixed with foreign pointers 
+         static int foreign;
+         ::std::vector<const void*> pointers;
+         for (auto e : entries) {
+            pointers.push_back(e->GetBlockStart());
+            pointers.push_back(e->GetBlockStart() + 1);
+            pointers.push_back(&foreign);
+         }
+
+         ::std::vector<const Allocation*> found(pointers.size());
+         Allocator::FindBatch(nullptr, pointers, found);
+         for (Count i = 0; i < entries.size(); ++i) {
+            REQUIRE(found[i * 3] == entries[i]);
+            REQUIRE(found[i * 3 + 1] == entries[i]);
+            REQUIRE(found[i * 3 + 2] == nullptr);
+         }
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+
+         for (Count i = 0; i < entries.size(); ++i)
+            REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, pointers[i * 3]));
+      }
+
+      WHEN("Searched for in a batch, with pointers into several pools interleaved") {
+         Allocator::CollectGarbage();
+
+         // Each of these fills a whole pool, except the large block    
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 4; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+         }
+         const auto large = Allocator::Allocate(nullptr, Pool::DefaultPoolSize * 2);
+         REQUIRE(large);
+
+         // Pointers go round-robin through the pools, so consecutive   
+         // ones are never in the same pool                             
+         static constexpr Count Rounds = 16;
+         ::std::vector<const void*> pointers;
+         for (Count k = 0; k < Rounds; ++k) {
+            for (auto e : entries)
+               pointers.push_back(e->GetBlockStart() + k);
+         }
+         for (Count k = 0; k < Rounds; k += 4)
+            pointers.insert(pointers.begin() + k * 5, large->GetBlockStart() + k);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto before = Allocator::GetStatistics();
+         #endif
+
+         ::std::vector<const Allocation*> found(pointers.size());
+         Allocator::FindBatch(nullptr, pointers, found);
+         for (Count i = 0; i < pointers.size(); ++i) {
+            const auto expected = ::std::find_if(entries.begin(), entries.end(),
+               [&](const Allocation* e) { return e->Contains(pointers[i]); });
+            if (expected != entries.end())
+               REQUIRE(found[i] == *expected);
+            else
+               REQUIRE(found[i] == large);
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            // Each block of 16 pointers looks up each pool at most     
+            // once, and each pointer to the large block once           
+            const auto after = Allocator::GetStatistics();
+            const auto blocks = (pointers.size() + 15) / 16;
+            REQUIRE(after.mFindHits + after.mFindMisses - before.mFindHits - before.mFindMisses
+               <= blocks * entries.size() + Rounds / 4);
+         #endif
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         Allocator::Deallocate(large);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("A pool deep inside a long chain is freed, and then reused") {
+         Allocator::CollectGarbage();
+
+         // Each of these fills a whole pool                            
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 32; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto pools = Allocator::GetStatistics().mPools;
+         #endif
+
+         const auto freed = entries[5];
+         Allocator::Deallocate(freed);
+         entries[5] = Allocator::Allocate(nullptr, HalfPool);
+
+         REQUIRE(entries[5] == freed);
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::GetStatistics().mPools == pools);
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Pools are released after a burst of allocations, and reused by the next one") {
+         Allocator::SetReserve(0, 0);
+         Allocator::SetReserve(4, 4 * Pool::DefaultPoolSize);
+         Allocator::CollectGarbage();
+
+         // Each of these fills a whole pool                            
+         ::std::vector<Allocation*> entries(4);
+         ::std::vector<const Byte*> blocks(4);
+         const auto burst = [&] {
+            for (Count i = 0; i < entries.size(); ++i) {
+               const auto e = entries[i] = Allocator::Allocate(nullptr, HalfPool);
+               REQUIRE(e);
+               ::std::memset(e->GetBlockStart(), 1, e->GetAllocatedSize());
+               blocks[i] = e->GetBlockStart();
+            }
+         };
+
+         burst();
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+
+         // Reserved pools are no longer ours                           
+         for (auto b : blocks)
+            REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, b));
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            auto before = Allocator::GetStatistics();
+         #endif
+
+         burst();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::GetStatistics().mReusedPools - before.mReusedPools == 4);
+            REQUIRE(Allocator::GetStatistics().mSynchronousPools == before.mSynchronousPools);
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         for (auto e : entries)
+            REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+
+         // Without demand, the reserve decays by half each collection  
+         Allocator::CollectGarbage();
+         Allocator::CollectGarbage();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            before = Allocator::GetStatistics();
+         #endif
+
+         burst();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::GetStatistics().mReusedPools - before.mReusedPools == 1);
+         #endif
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Garbage is collected incrementally, within a time budget, and in parallel") {
+         Allocator::CollectGarbage();
+
+         // Each of these fills a whole pool, and is followed by a few  
+         // small entries in another pool, that will leave holes        
+         ::std::vector<Allocation*> entries;
+         ::std::vector<Allocation*> small;
+         for (Count i = 0; i < 64; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+            ::std::memset(entries.back()->GetBlockStart(), int(i), entries.back()->GetAllocatedSize());
+            for (Count j = 0; j < 8; ++j) {
+               small.push_back(Allocator::Allocate(nullptr, 64));
+               REQUIRE(small.back());
+            }
+         }
+
+         for (Count i = 1; i < entries.size(); i += 2)
+            Allocator::Deallocate(entries[i]);
+         for (Count i = 1; i < small.size(); i += 2)
+            Allocator::Deallocate(small[i]);
+
+         // A zero budget processes a single batch per call             
+         Count calls = 0;
+         Count released = 0;
+         Allocator::GarbageProgress progress;
+         do {
+            progress = Allocator::CollectGarbage(::std::chrono::nanoseconds::zero());
+            REQUIRE(progress.mVisited);
+            REQUIRE(progress.mChain <= progress.mChains);
+            released += progress.mReleased;
+            ++calls;
+         }
+         while (not progress.mDone);
+
+         REQUIRE(calls > 1);
+         REQUIRE(released == 32);
+         REQUIRE(progress.mChain == progress.mChains);
+
+         // Whole pass at once, spread across threads                   
+         progress = Allocator::CollectGarbage(::std::chrono::nanoseconds::max(), 4);
+         REQUIRE(progress.mDone);
+         REQUIRE(progress.mReleased == 0);
+
+         bool intact = true;
+         for (Count i = 0; i < entries.size(); i += 2) {
+            const auto e = entries[i];
+            intact &= Allocator::Find(nullptr, e->GetBlockStart()) == e;
+            intact &= e->GetBlockStart()[e->GetAllocatedSize() - 1].mValue == i;
+         }
+         REQUIRE(intact);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         for (Count i = 0; i < entries.size(); i += 2)
+            Allocator::Deallocate(entries[i]);
+         for (Count i = 0; i < small.size(); i += 2)
+            Allocator::Deallocate(small[i]);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Pools become empty, and only they are collected") {
+         Allocator::CollectGarbage();
+
+         // Each of these fills a whole pool                            
+         ::std::vector<Allocation*> entries;
+         ::std::vector<const Byte*> blocks;
+         for (Count i = 0; i < 16; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+            blocks.push_back(entries.back()->GetBlockStart());
+         }
+
+         // The last pool is claimed by this thread, so it isn't freed  
+         for (Count i = 0; i < entries.size(); i += 2)
+            Allocator::Deallocate(entries[i]);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto pools = Allocator::GetStatistics().mPools;
+         #endif
+
+         REQUIRE(Allocator::CollectEmptyPools() == 8);
+         REQUIRE(Allocator::CollectEmptyPools() == 0);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::GetStatistics().mPools == pools - 8);
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         for (Count i = 0; i < entries.size(); i += 2)
+            REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, blocks[i]));
+         for (Count i = 1; i < entries.size(); i += 2)
+            REQUIRE(Allocator::Find(nullptr, entries[i]->GetBlockStart()) == entries[i]);
+
+         // A pool that became empty, and then was reused, is kept      
+         Allocator::Deallocate(entries[1]);
+         entries[1] = Allocator::Allocate(nullptr, HalfPool);
+         REQUIRE(entries[1]);
+         REQUIRE(Allocator::CollectEmptyPools() == 0);
+
+         for (Count i = 1; i < entries.size(); i += 2)
+            Allocator::Deallocate(entries[i]);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("An entry bigger than a default pool is allocated, resized and deallocated") {
+         Allocator::CollectGarbage();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto before = Allocator::GetStatistics();
+         #endif
+
+         constexpr Offset size = 5 * 1024 * 1024;
+         entry = Allocator::Allocate(nullptr, size);
+         REQUIRE(entry);
+         REQUIRE(entry->GetAllocatedSize() == size);
+         REQUIRE(IsAligned(entry->GetBlockStart()));
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            // Only the required pages are mapped, no pool is made      
+            auto stats = Allocator::GetStatistics();
+            REQUIRE(stats.mPools == before.mPools);
+            REQUIRE(stats.mBytesAllocatedByBackend - before.mBytesAllocatedByBackend
+               < size + Pool::DefaultPoolSize);
+         #endif
+
+         const auto start = entry->GetBlockStart();
+         start[0].mValue = 1;
+         start[size - 1].mValue = 2;
+         REQUIRE(Allocator::CheckAuthority(nullptr, start + size / 2));
+         REQUIRE(Allocator::Find(nullptr, start + size / 2) == entry);
+         REQUIRE(Allocator::Find(nullptr, start + size) == nullptr);
+
+         // Shrinking happens in place, and gives the tail pages back   
+         REQUIRE(Allocator::Reallocate(size / 2, entry) == entry);
+         REQUIRE(entry->GetAllocatedSize() == size / 2);
+         REQUIRE(Allocator::Find(nullptr, start + size / 2) == nullptr);
+         REQUIRE(Allocator::CheckAuthority(nullptr, start + size / 2));
+         REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, start + size / 2 + GetPageSize()));
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            stats = Allocator::GetStatistics();
+            REQUIRE(stats.mBytesAllocatedByBackend - before.mBytesAllocatedByBackend
+               < size / 2 + GetPageSize() * 2);
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         // Growing back within the pages that are left is in place too 
+         REQUIRE(Allocator::Reallocate(size / 2 + 1, entry) == entry);
+         start[size / 2].mValue = 3;
+
+         Allocator::Deallocate(entry);
+         REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, start));
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::GetStatistics() == before);
+         #endif
+      }
+
+      WHEN("Entries are allocated with alignments beyond the default one") {
+         Allocator::CollectGarbage();
+
+         ::std::vector<Allocation*> entries;
+         for (Offset alignment : {Offset {64}, Offset {4096}, Offset {2 * 1024 * 1024}}) {
+            for (Offset size : {Offset {1}, Offset {100}, Offset {5000}}) {
+               const auto e = Allocator::Allocate(nullptr, size, alignment);
+               REQUIRE(e);
+               REQUIRE(e->GetAllocatedSize() >= size);
+               REQUIRE(reinterpret_cast<Pointer>(e->GetBlockStart()) % alignment == 0);
+               ::std::memset(e->GetBlockStart(), 0xFF, size);
+               entries.push_back(e);
+            }
+         }
+
+         // Aligned entries are managed like any other                  
+         for (auto e : entries) {
+            REQUIRE(e->GetUses() == 1);
+            REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+            REQUIRE(Allocator::Find(nullptr, e->GetBlockEnd() - 1) == e);
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         // Entries that can't grow in place keep their alignment       
+         const auto moved = Allocator::Reallocate(Pool::DefaultPoolSize / 2, entries[0]);
+         REQUIRE(moved);
+         REQUIRE(moved != entries[0]);
+         REQUIRE(reinterpret_cast<Pointer>(moved->GetBlockStart()) % 64 == 0);
+         Allocator::Deallocate(entries[0]);
+         entries[0] = moved;
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Entries are allocated and deallocated in batches") {
+         Allocator::CollectGarbage();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto before = Allocator::GetStatistics();
+         #endif
+
+         // More than a single pool can contain                         
+         ::std::vector<Allocation*> entries(Pool::DefaultPoolSize / 64);
+         REQUIRE(Allocator::AllocateBatch(nullptr, 64, entries) == entries.size());
+
+         for (auto e : entries) {
+            REQUIRE(e);
+            REQUIRE(e->GetUses() == 1);
+            REQUIRE(e->GetAllocatedSize() >= 64);
+            REQUIRE(IsAligned(e->GetBlockStart()));
+            ::std::memset(e->GetBlockStart(), 0xFF, 64);
+         }
+
+         for (auto e : entries)
+            REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+
+         auto sorted = entries;
+         ::std::sort(sorted.begin(), sorted.end());
+         REQUIRE(::std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto during = Allocator::GetStatistics();
+            REQUIRE(during.mEntries - before.mEntries == entries.size());
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         // Batches can also be written to a plain array                
+         Allocation* few[3] {};
+         REQUIRE(Allocator::AllocateBatch(nullptr, 16, 3, few) == 3);
+         for (auto e : few) {
+            REQUIRE(e);
+            REQUIRE(e->GetAllocatedSize() >= 16);
+            entries.push_back(e);
+         }
+
+         // Large entries can be freed along with the pooled ones       
+         entries.push_back(Allocator::Allocate(nullptr, 5 * 1024 * 1024));
+         REQUIRE(entries.back());
+         Allocator::DeallocateBatch(entries);
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto after = Allocator::GetStatistics();
+            REQUIRE(after.mEntries == before.mEntries);
+            REQUIRE(after.mBytesAllocatedByFrontend == before.mBytesAllocatedByFrontend);
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Entries are allocated in a region, which is reset, and then destroyed") {
+         Allocator::CollectGarbage();
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto before = Allocator::GetStatistics();
+         #endif
+
+         const Byte* start;
+         ::std::vector<Allocation*> entries;
+         {
+            Region region;
+            const auto fill = [&] {
+               entries.clear();
+               for (Count i = 0; i < 4096; ++i) {
+                  const auto e = region.Allocate(1 + (i * 37) % 1000);
+                  REQUIRE(e);
+                  REQUIRE(IsAligned(e->GetBlockStart()));
+                  ::std::memset(e->GetBlockStart(), 0xFF, e->GetAllocatedSize());
+                  entries.push_back(e);
+               }
+            };
+
+            fill();
+            const auto pools = region.GetPoolCount();
+            REQUIRE(pools > 1);
+            for (auto e : entries) {
+               REQUIRE(region.Contains(e->GetBlockStart()));
+               REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+            }
+
+            // Entries too big for the region's pools get their own     
+            const auto big = region.Allocate(Pool::DefaultPoolSize * 2);
+            REQUIRE(big);
+            REQUIRE(Allocator::Find(nullptr, big->GetBlockStart()) == big);
+            REQUIRE(region.GetPoolCount() == pools + 1);
+
+            // Entries can still be deallocated one by one, from any    
+            // thread - they're recycled the next time the region bumps 
+            // and the top of the stack is reused right away            
+            const auto frontend = region.GetAllocatedByFrontend();
+            const auto last = entries.back();
+            const auto lastBytes = last->GetTotalSize();
+            ::std::thread {[last] { Allocator::Deallocate(last); }}.join();
+            REQUIRE(region.GetAllocatedByFrontend() == frontend);
+
+            const auto tiny = region.Allocate(1);
+            REQUIRE(tiny == last);
+            REQUIRE(region.GetAllocatedByFrontend() == frontend - lastBytes + tiny->GetTotalSize());
+            REQUIRE(Allocator::Find(nullptr, tiny->GetBlockStart()) == tiny);
+
+            // Reset keeps the pools, and forgets all entries           
+            start = entries.front()->GetBlockStart();
+            region.Reset();
+            REQUIRE(region.GetAllocatedByFrontend() == 0);
+            REQUIRE(region.GetPoolCount() == pools + 1);
+            for (auto e : entries) {
+               REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == nullptr);
+               REQUIRE(Allocator::CheckAuthority(nullptr, e->GetBlockStart()));
+            }
+
+            fill();
+            REQUIRE(region.GetPoolCount() == pools + 1);
+            for (auto e : entries)
+               REQUIRE(Allocator::Find(nullptr, e->GetBlockStart()) == e);
+
+            #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+               // Regions don't touch the pool chains, but their entries
+               // are counted, until they're forgotten                  
+               const auto after = Allocator::GetStatistics();
+               REQUIRE(after.mPools == before.mPools);
+               REQUIRE(after.mEntries == before.mEntries + entries.size());
+               REQUIRE(after.mBytesAllocatedByFrontend
+                  == before.mBytesAllocatedByFrontend + region.GetAllocatedByFrontend());
+               REQUIRE(Allocator::IntegrityCheck());
+            #endif
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto after = Allocator::GetStatistics();
+            REQUIRE(after.mEntries == before.mEntries);
+            REQUIRE(after.mBytesAllocatedByFrontend == before.mBytesAllocatedByFrontend);
+         #endif
+
+         REQUIRE_FALSE(Allocator::CheckAuthority(nullptr, start));
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+   }
+}
+
+SCENARIO("Testing allocator from multiple threads", "[allocator]") {
+   static constexpr Count Threads = 8;
+   static constexpr Count Entries = 4096;
+
+   GIVEN("Several threads") {
+      Allocator::CollectGarbage();
+      ::std::atomic<Count> failures {};
+
+      WHEN("Each thread allocates and deallocates its own memory") {
+         ::std::vector<::std::thread> threads;
+         for (Count t = 0; t < Threads; ++t) {
+            threads.emplace_back([&failures, t] {
+               ::std::vector<Allocation*> entries;
+               for (Count i = 0; i < Entries; ++i) {
+                  const Offset size = 1 + (i * 7 + t) % 600;
+                  auto entry = Allocator::Allocate(nullptr, size);
+                  if (not entry) {
+                     ++failures;
+                     continue;
+                  }
+
+                  ::std::memset(entry->GetBlockStart(), int(t), entry->GetAllocatedSize());
+                  entries.push_back(entry);
+               }
+
+               for (auto entry : entries) {
+                  const auto raw = entry->GetBlockStart();
+                  if (raw[0].mValue != t or raw[entry->GetAllocatedSize() - 1].mValue != t)
+                     ++failures;
+                  Allocator::Deallocate(entry);
+               }
+            });
+         }
+
+         for (auto& thread : threads)
+            thread.join();
+
+         REQUIRE(failures == 0);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Memory is allocated by one thread, and deallocated by others") {
+         ::std::vector<Allocation*> entries(Entries * Threads);
+         ::std::thread producer {[&] {
+            for (auto& entry : entries) {
+               entry = Allocator::Allocate(nullptr, 32);
+               if (not entry)
+                  ++failures;
+            }
+         }};
+         producer.join();
+         REQUIRE(failures == 0);
+
+         ::std::vector<::std::thread> consumers;
+         for (Count t = 0; t < Threads; ++t) {
+            consumers.emplace_back([&entries, t] {
+               for (Count i = t; i < entries.size(); i += Threads)
+                  Allocator::Deallocate(entries[i]);
+            });
+         }
+
+         for (auto& thread : consumers)
+            thread.join();
+
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Memory is allocated in a batch by one thread, and deallocated in batches by others") {
+         // This thread keeps its pools claimed, so the other threads   
+         // have to queue what they free                                
+         ::std::vector<Allocation*> entries(Entries * Threads);
+         REQUIRE(Allocator::AllocateBatch(nullptr, 32, entries) == entries.size());
+
+         ::std::vector<::std::thread> consumers;
+         const auto chunk = entries.size() / (Threads + 1);
+         for (Count t = 0; t < Threads; ++t) {
+            consumers.emplace_back([&entries, chunk, t] {
+               Allocator::DeallocateBatch(::std::span {entries}.subspan(t * chunk, chunk));
+            });
+         }
+
+         Allocator::DeallocateBatch(::std::span {entries}.subspan(Threads * chunk));
+         for (auto& thread : consumers)
+            thread.join();
+
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Pools are prepared in the background, while a thread allocates") {
+         REQUIRE(Allocator::StartProvisioner(4));
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto before = Allocator::GetStatistics();
+         #endif
+
+         // Each of these fills a whole pool                            
+         ::std::vector<Allocation*> entries;
+         for (Count i = 0; i < 64; ++i) {
+            entries.push_back(Allocator::Allocate(nullptr, HalfPool));
+            REQUIRE(entries.back());
+            ::std::memset(entries.back()->GetBlockStart(), 1, entries.back()->GetAllocatedSize());
+         }
+
+         #if LANGULUS_FEATURE(MEMORY_STATISTICS)
+            const auto after = Allocator::GetStatistics();
+            REQUIRE(after.mPools - before.mPools == entries.size());
+            REQUIRE(after.mProvisionedPools + after.mSynchronousPools + after.mReusedPools
+               - before.mProvisionedPools - before.mSynchronousPools - before.mReusedPools
+               == entries.size());
+            REQUIRE(Allocator::IntegrityCheck());
+         #endif
+
+         for (auto e : entries)
+            Allocator::Deallocate(e);
+
+         Allocator::StopProvisioner();
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Memory is deallocated by other threads, while its owner gives its pools back") {
+         ::std::vector<Allocation*> entries(Entries * 2);
+         ::std::vector<const Pool*> pools(entries.size());
+         ::std::atomic<bool> ready {};
+
+         // The producer exits right after handing out the entries, so  
+         // its claimed pools are given back while consumers still free 
+         ::std::thread producer {[&] {
+            for (Count i = 0; i < entries.size(); ++i) {
+               entries[i] = Allocator::Allocate(nullptr, 24);
+               if (not entries[i])
+                  ++failures;
+               else
+                  pools[i] = entries[i]->GetPool();
+            }
+            ready = true;
+         }};
+
+         ::std::vector<::std::thread> consumers;
+         for (Count t = 0; t < Threads; ++t) {
+            consumers.emplace_back([&entries, &ready, t] {
+               while (not ready)
+                  ::std::this_thread::yield();
+               for (Count i = t; i < entries.size(); i += Threads)
+                  Allocator::Deallocate(entries[i]);
+            });
+         }
+
+         producer.join();
+         for (auto& thread : consumers)
+            thread.join();
+         REQUIRE(failures == 0);
+
+         // No entry may be stuck in a queue, that nobody drains        
+         for (auto pool : pools)
+            REQUIRE_FALSE(pool->IsInUse());
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Memory is searched for by other threads, while its pool keeps changing") {
+         static constexpr Count Pairs = Threads / 2;
+         ::std::atomic<Allocation*> mailbox[Pairs] {};
+         ::std::atomic<bool> done {};
+
+         // Owners keep allocating and deallocating around each entry,  
+         // while searchers look for it without any locks               
+         ::std::vector<::std::thread> threads;
+         for (Count t = 0; t < Pairs; ++t) {
+            threads.emplace_back([&mailbox, &failures, t] {
+               ::std::vector<Allocation*> churn;
+               for (Count i = 0; i < Entries / 4; ++i) {
+                  const auto entry = Allocator::Allocate(nullptr, 8 + (i * 13 + t) % 500);
+                  if (not entry) {
+                     ++failures;
+                     continue;
+                  }
+
+                  mailbox[t].store(entry, ::std::memory_order_release);
+                  while (mailbox[t].load(::std::memory_order_acquire)) {
+                     if (churn.size() < 64) {
+                        const auto other = Allocator::Allocate(nullptr, 8 + churn.size() * 3);
+                        if (not other)
+                           ++failures;
+                        else
+                           churn.push_back(other);
+                     }
+                     else {
+                        for (auto other : churn)
+                           Allocator::Deallocate(other);
+                        churn.clear();
+                     }
+                  }
+
+                  Allocator::Deallocate(entry);
+               }
+
+               for (auto other : churn)
+                  Allocator::Deallocate(other);
+            });
+
+            threads.emplace_back([&mailbox, &failures, &done, t] {
+               while (not done) {
+                  const auto entry = mailbox[t].load(::std::memory_order_acquire);
+                  if (not entry)
+                     continue;
+
+                  const auto last = entry->GetBlockStart() + entry->GetAllocatedSize() - 1;
+                  if (Allocator::Find(nullptr, entry->GetBlockStart()) != entry
+                  or  Allocator::Find(nullptr, last) != entry
+                  or  not Allocator::CheckAuthority(nullptr, last))
+                     ++failures;
+                  mailbox[t].store(nullptr, ::std::memory_order_release);
+               }
+            });
+         }
+
+         for (Count t = 0; t < Pairs; ++t)
+            threads[t * 2].join();
+         done = true;
+         for (Count t = 0; t < Pairs; ++t)
+            threads[t * 2 + 1].join();
+
+         REQUIRE(failures == 0);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
+
+      WHEN("Memory is deallocated by other threads, while still being allocated") {
+         ::std::atomic<Allocation*> mailbox[Threads] {};
+         ::std::atomic<bool> done {};
+
+         ::std::vector<::std::thread> consumers;
+         for (Count t = 0; t < Threads; ++t) {
+            consumers.emplace_back([&mailbox, &done, t] {
+               while (true) {
+                  const bool finished = done;
+                  const auto entry = mailbox[t].exchange(nullptr);
+                  if (entry)
+                     Allocator::Deallocate(entry);
+                  else if (finished)
+                     break;
+               }
+            });
+         }
+
+         for (Count i = 0; i < Entries; ++i) {
+            const auto entry = Allocator::Allocate(nullptr, 16 + i % 128);
+            if (not entry) {
+               ++failures;
+               continue;
+            }
+
+            auto& box = mailbox[i % Threads];
+            Allocation* expected = nullptr;
+            while (not box.compare_exchange_weak(expected, entry))
+               expected = nullptr;
+         }
+
+         done = true;
+         for (auto& thread : consumers)
+            thread.join();
+
+         REQUIRE(failures == 0);
+         REQUIRE_FALSE(Allocator::CollectGarbage());
+      }
    }
 }